@@ -3,17 +3,22 @@
 #include "DataTables.h"
 #include "Utility.h"
 #include "SoundNode.h"
+#include "WorldSnapshot.h"
+#include "SceneRegistry.h"
+#include "MovementSystem.h"
 #include <string>
 
 namespace {
-	const std::map<Aircraft::Type, AircraftData> TABLE = initializeAircraftData();
+	// Reloaded in place when the entity tables change
+	const AircraftTable& TABLE = entityTables().aircraft;
 }
 
 
 Aircraft::Aircraft(Type t, const TextureHolder_t& textures, const FontHolder_t& fonts)
-	: Entity(TABLE.at(t).hitpoints)
+	: Entity(TABLE[t].hitpoints)
 	, type(t)
-	, sprite(textures.get(TABLE.at(t).texture), TABLE.at(t).textureRect)
+	, identifier(0)
+	, sprite(textures.get(TABLE[t].texture), TABLE[t].textureRect)
 	, explosion(textures.get(TextureID::Explosion))
 	, showExplosion(true)
 	, spawnedPickup(false)
@@ -30,8 +35,11 @@ Aircraft::Aircraft(Type t, const TextureHolder_t& textures, const FontHolder_t&
 	, missileAmmo(10)
 	, travelledDistance(0)
 	, directionIndex(0)
+	, movement(nullptr)
+	, movementSlot(0)
 	, healthDisplay(nullptr)
 	, missileDisplay(nullptr)
+	, random(createRandomStream())
 {
 
 	explosion.setFrameSize(sf::Vector2i(256, 256));
@@ -93,6 +101,95 @@ bool Aircraft::isMarkedForRemoval() const
 	return isDestroyed() &&(explosion.isFinished()|| !showExplosion);
 }
 
+Aircraft::Type Aircraft::getType() const
+{
+	return type;
+}
+
+void Aircraft::setIdentifier(int identifier)
+{
+	this->identifier = identifier;
+}
+
+int Aircraft::getIdentifier() const
+{
+	return identifier;
+}
+
+void Aircraft::updateRemote(sf::Time dt)
+{
+	updateTexts();
+
+	if (isDestroyed())
+		updateWreck(dt);
+}
+
+Aircraft::~Aircraft()
+{
+	if (movement)
+		movement->remove(movementSlot);
+}
+
+void Aircraft::placeOnPath(float distance)
+{
+	const FlightPath& path = TABLE[type].path;
+	if (path.isEmpty())
+		return;
+
+	move(path.getPosition(distance) - path.getPosition(0.f));
+	travelledDistance = distance;
+}
+
+AircraftState Aircraft::saveState() const
+{
+	AircraftState state;
+	state.random = random;
+	state.fireCountdown = fireCountdown.asMicroseconds();
+	state.explosionTime = explosion.getProgress().asMicroseconds();
+	state.type = static_cast<std::int32_t>(type);
+	state.hitpoints = getHitpoints();
+	state.x = getPosition().x;
+	state.y = getPosition().y;
+	state.rotation = getRotation();
+	state.vx = getVelocity().x;
+	state.vy = getVelocity().y;
+	state.travelledDistance = movement ? movement->getTravelledDistance(movementSlot) : travelledDistance;
+	state.directionIndex = static_cast<std::uint32_t>(movement ? movement->getDirectionIndex(movementSlot) : directionIndex);
+	state.missileAmmo = missileAmmo;
+	state.fireRateLevel = fireRateLevel;
+	state.spreadLevel = spreadLevel;
+	state.spawnedPickup = spawnedPickup;
+	state.playedExplosionEffect = playedExplosionEffect;
+	state.showExplosion = showExplosion;
+	state.padding = 0;
+	state.scheduled = -1;
+	state.identifier = identifier;
+	return state;
+}
+
+void Aircraft::loadState(const AircraftState& state)
+{
+	random = state.random;
+	identifier = state.identifier;
+	fireCountdown = sf::microseconds(state.fireCountdown);
+	setHitpoints(state.hitpoints);
+	setPosition(state.x, state.y);
+	setRotation(state.rotation);
+	setVelocity(state.vx, state.vy);
+	travelledDistance = state.travelledDistance;
+	directionIndex = state.directionIndex;
+	missileAmmo = state.missileAmmo;
+	fireRateLevel = state.fireRateLevel;
+	spreadLevel = state.spreadLevel;
+	spawnedPickup = state.spawnedPickup != 0;
+	playedExplosionEffect = state.playedExplosionEffect != 0;
+	showExplosion = state.showExplosion != 0;
+
+	if (state.explosionTime > 0)
+		explosion.update(sf::microseconds(state.explosionTime));
+	updateTexts();
+}
+
 void Aircraft::increaseFireRate()
 {
 	const int MAX_FIRE_RATE = 10;
@@ -114,7 +211,7 @@ void Aircraft::collectMissiles(size_t count)
 
 void Aircraft::fire()
 {
-	if (TABLE.at(type).fireInterval != sf::Time::Zero) {
+	if (TABLE[type].fireInterval != sf::Time::Zero) {
 		isFiring = true;
 	}
 }
@@ -127,18 +224,11 @@ void Aircraft::launchMissile()
 	}
 }
 
-void Aircraft::playLocalSound(CommandQueue& commands, EffectID effect)
+void Aircraft::playLocalSound(EffectID effect)
 {
-	auto worldPosition = getWorldPosition();
-
-	Command command;
-		command.category = Category::SoundEffect;
-		command.action = derivedAction<SoundNode>(
-			[effect, worldPosition](SoundNode& node, sf::Time dt)
-			{
-				node.playSound(effect, worldPosition);
-			});
-		commands.push(command);
+	SoundNode* soundNode = getRegistry() ? getRegistry()->getSoundNode() : nullptr;
+	if (soundNode)
+		soundNode->playSound(effect, getWorldPosition());
 }
 
 
@@ -157,17 +247,12 @@ void Aircraft::updateCurrent(sf::Time dt, CommandQueue& commands)
 
 	if (isDestroyed()) {
 		checkPickupDrop(commands);
-		explosion.update(dt);
-		
-		if (!playedExplosionEffect) 
-		{
-			EffectID effect = (randomInt(2) == 0 ? EffectID::Explosion1 : EffectID::Explosion2);
-			playLocalSound(commands, effect);
-			playedExplosionEffect = true;
-		}
-			return;
+		updateWreck(dt);
+		return;
 	}
-	updateMovementPattern(dt);
+	// the movement system stepped the pattern before the scene update
+	if (movement)
+		setVelocity(movement->getVelocity(movementSlot));
 	
 	checkProjectileLaunch(dt, commands);
 
@@ -175,6 +260,18 @@ void Aircraft::updateCurrent(sf::Time dt, CommandQueue& commands)
 	
 }
 
+void Aircraft::updateWreck(sf::Time dt)
+{
+	explosion.update(dt);
+
+	if (!playedExplosionEffect)
+	{
+		EffectID effect = (random.nextInt(2) == 0 ? EffectID::Explosion1 : EffectID::Explosion2);
+		playLocalSound(effect);
+		playedExplosionEffect = true;
+	}
+}
+
 void Aircraft::updateTexts()
 {
 	healthDisplay->setString(std::to_string(getHitpoints())+" HP");
@@ -192,21 +289,14 @@ void Aircraft::updateTexts()
 	}
 }
 
-void Aircraft::updateMovementPattern(sf::Time dt)
+void Aircraft::onAttach(SceneRegistry& registry)
 {
-	//enemy plane movement
-	const std::vector<Direction>& directions = TABLE.at(type).directions;
-	if (!directions.empty()) {
-		if (travelledDistance > directions[directionIndex].distance) {
-			directionIndex = (directionIndex + 1) % directions.size();
-			travelledDistance = 0.f;
-		}
-
-		float radians = toRadian(directions[directionIndex].angle + 90.f);
-		float vx = getMaxSpeed() * std::cos(radians);
-		float vy = getMaxSpeed() * std::sin(radians);
-		setVelocity(vx, vy);
-		travelledDistance += getMaxSpeed() * dt.asSeconds();
+	// enemy plane movement; the player's table entry has no pattern
+	MovementSystem* system = registry.getMovementSystem();
+	if (system && !movement && (!TABLE[type].directions.empty() || !TABLE[type].path.isEmpty()))
+	{
+		system->add(type, travelledDistance, directionIndex, movementSlot);
+		movement = system;
 	}
 }
 
@@ -217,12 +307,12 @@ sf::FloatRect Aircraft::getBoundingRect() const
 
 float Aircraft::getMaxSpeed()
 {
-	return TABLE.at(type).speed;
+	return TABLE[type].speed;
 }
 
 void Aircraft::checkPickupDrop(CommandQueue& commands)
 {
-	if ((!isAllied() && randomInt(2) == 0) && !spawnedPickup) 
+	if ((!isAllied() && random.nextInt(2) == 0) && !spawnedPickup) 
 		commands.push(dropPickupCommand);
 	
 	spawnedPickup = true;
@@ -236,8 +326,8 @@ void Aircraft::checkProjectileLaunch(sf::Time dt, CommandQueue& commands)
 	if (isFiring && fireCountdown <= sf::Time::Zero)
 	{
 		commands.push(fireCommand);
-		fireCountdown += TABLE.at(type).fireInterval / (fireRateLevel + 1.f);
-		playLocalSound(commands, 
+		fireCountdown += TABLE[type].fireInterval / (fireRateLevel + 1.f);
+		playLocalSound(
 			isAllied() ? EffectID::AlliedGunfire : EffectID::EnemyGunfire);
 	}
 	else if (fireCountdown > sf::Time::Zero)
@@ -251,7 +341,7 @@ void Aircraft::checkProjectileLaunch(sf::Time dt, CommandQueue& commands)
 		commands.push(missileCommand);
 		isLaunchingMissile = false;
 
-		playLocalSound(commands, EffectID::LaunchMissile);	
+		playLocalSound(EffectID::LaunchMissile);	
 	}
 }
 
@@ -290,10 +380,10 @@ void Aircraft::createProjectile(SceneNode& node, Projectile::Type type, float xO
 	node.attachChild(std::move(projectile));
 }
 
-void Aircraft::createPickup(SceneNode& node, const TextureHolder_t& textures) const
+void Aircraft::createPickup(SceneNode& node, const TextureHolder_t& textures)
 {
 	
-	auto type = static_cast<Pickup::Type>(randomInt(static_cast<int>(Pickup::Type::TypeCount)));
+	auto type = static_cast<Pickup::Type>(random.nextInt(static_cast<int>(Pickup::Type::TypeCount)));
 
 	std::unique_ptr<Pickup> pickup(new Pickup(type, textures));
 	pickup->setPosition(getWorldPosition());
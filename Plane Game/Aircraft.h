@@ -7,15 +7,20 @@
 #include "Command.h"
 #include "Projectile.h"
 #include "Animation.h"
+#include "Random.h"
 #include <SFML/Graphics/Sprite.hpp>
 
+struct AircraftState;
+class MovementSystem;
+
 class Aircraft : public Entity
 {
 public:
-	enum class Type {Eagle, Raptor, Avenger};
+	enum class Type {Eagle, Raptor, Avenger, Viper, TypeCount};
 
 public:
 						    Aircraft(Type t, const TextureHolder_t& textures, const FontHolder_t& fonts);
+							~Aircraft();
 
 	virtual unsigned int	getCategory() const override;
 	virtual bool			isMarkedForRemoval() const override;
@@ -27,15 +32,34 @@ public:
 	void					fire();
 	void					launchMissile();
 
-	void					playLocalSound(CommandQueue& commands, EffectID effect);
+	void					playLocalSound(EffectID effect);
+
+	Type					getType() const;
+	// Which player flies it, 0 for the host
+	void					setIdentifier(int identifier);
+	int						getIdentifier() const;
+
+	// Co-op clients only animate what the host simulates
+	void					updateRemote(sf::Time dt);
+
+	// Before attaching: moves a fresh aircraft `distance` along its type's
+	// flight path, measured from where the path starts; negative distances lie
+	// before the start, on its first heading. No effect without one.
+	void					placeOnPath(float distance);
+
+	AircraftState			saveState() const;
+	// Expects a freshly constructed aircraft of the same type
+	void					loadState(const AircraftState& state);
 
 
 private:
 	virtual void			drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const override;
 	
 	virtual void			updateCurrent(sf::Time dt, CommandQueue& commands) override;
+	virtual void			onAttach(SceneRegistry& registry) override;
 	void					updateTexts();
-	void					updateMovementPattern(sf::Time dt);
+	// Explosion animation and its sound, on the host and on clients alike
+	void					updateWreck(sf::Time dt);
 
 	virtual sf::FloatRect	getBoundingRect() const;
 	float					getMaxSpeed();
@@ -47,11 +71,12 @@ private:
 												float xOffset,float yOffset,
 												const TextureHolder_t& textures) const;
 
-	void                    createPickup(SceneNode& node, const TextureHolder_t& textures) const;
+	void                    createPickup(SceneNode& node, const TextureHolder_t& textures);
 	
 	bool					isAllied() const;
 private:
 	Type					type;
+	int						identifier;
 	sf::Sprite				sprite;
 	Animation				explosion;
 	bool					showExplosion;
@@ -71,12 +96,18 @@ private:
 	int						fireRateLevel;
 	int						spreadLevel;
 
+	// Pattern state until attached, then kept by the movement system
 	float					travelledDistance;
 	size_t					directionIndex;
+	MovementSystem*			movement;
+	size_t					movementSlot;
 
 	TextNode*				healthDisplay;
 	TextNode*				missileDisplay;
 
+	// Own stream, so drops do not depend on the update order of other entities
+	RandomStream			random;
+
 	
 };
 
@@ -84,6 +84,11 @@ bool Animation::isFinished() const
 	return currentFrame >= numFrames;
 }
 
+sf::Time Animation::getProgress() const
+{
+	return duration / static_cast<float>(numFrames) * static_cast<float>(currentFrame) + elapsedTime;
+}
+
 sf::FloatRect Animation::getLocalBounds() const
 {
 	return sf::FloatRect(getOrigin(), static_cast<sf::Vector2f>(getFrameSize()));
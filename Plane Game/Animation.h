@@ -24,6 +24,8 @@ public:
 
 	void 					restart(); 
 	bool 					isFinished() const;
+	// Time played since the last restart, update() with it reproduces the frame
+	sf::Time				getProgress() const;
 
 	sf::FloatRect 			getLocalBounds() const;
 	sf::FloatRect 			getGlobalBounds() const;
@@ -9,17 +9,37 @@
 #include "MenuState.h"
 #include "GexState.h"
 #include "GameOverState.h"
+#include "LoadingState.h"
 
 const sf::Time Application::TimePerFrame = sf::seconds(1.f / 60.f);
 
-Application::Application()
+namespace
+{
+	std::unique_ptr<WorldSnapshot> loadStartSnapshot(const std::string& filename)
+	{
+		std::unique_ptr<WorldSnapshot> snapshot;
+		if (!filename.empty())
+		{
+			snapshot.reset(new WorldSnapshot());
+			snapshot->loadFromFile(filename);
+		}
+		return snapshot;
+	}
+}
+
+Application::Application(const std::string& replayFile, const NetworkSettings& network, const std::string& snapshotFile)
     : window(sf::VideoMode(1280, 720), "SFML works!")
+    , workers()
+    , loader(workers)
     , textures()
     , fonts()
     , player()
-    , music()
-    , sounds()
-    , stateStack(State::Context(window,textures,fonts,player,music,sounds))
+    , music(workers)
+    , sounds(loader)
+    , profiler()
+    , network(network)
+    , startSnapshot(loadStartSnapshot(snapshotFile))
+    , stateStack(State::Context(window,textures,fonts,player,music,sounds,workers,loader,profiler,this->network,startSnapshot.get()))
     , statsText()
     , statsUpdateTime()
     , statsNumFrames(0)
@@ -27,13 +47,28 @@ Application::Application()
 {
     window.setKeyRepeatEnabled(false);
 
+    // The loading screen itself needs these, so they load up front
     fonts.load(FontID::Main, "Media/Sansation.ttf");
     textures.load(TextureID::TitleScreen, "Media/Textures/TitleScreen.png");
     statsText.setFont(fonts.get(FontID::Main));
     statsText.setPosition(5.f, 5.f);
     statsText.setCharacterSize(10u);
     registerStates();
-    stateStack.pushState(StateID::Title);
+    if (!replayFile.empty())
+    {
+        player.getReplay().loadFromFile(replayFile);
+        player.getReplay().startPlayback();
+        stateStack.pushState(StateID::Game);
+    }
+    else if (network.role != NetworkSettings::Role::Offline || startSnapshot)
+    {
+        stateStack.pushState(StateID::Game);
+    }
+    else
+    {
+        stateStack.pushState(StateID::Title);
+    }
+    stateStack.pushState(StateID::Loading);
 
     music.setVolume(25.f);
 }
@@ -56,6 +91,7 @@ void Application::run()
             if (stateStack.isEmpty())
                 window.close();
         }
+        profiler.beginFrame(elapsedTime);
         updateStatistics(elapsedTime);
         render();
     }
@@ -76,6 +112,7 @@ void Application::processInput()
 void Application::update(sf::Time dt)
 {
     stateStack.update(dt);
+    music.update(dt);
 }
 
 void Application::render()
@@ -98,7 +135,8 @@ void Application::updateStatistics(sf::Time et)
 
         statsText.setString(
             "Frames/ Second = " + std::to_string(statsNumFrames) + "\n" +
-            "Time/ Update = " + std::to_string(statsUpdateTime.asMicroseconds() / statsNumFrames) + "us"
+            "Time/ Update = " + std::to_string(statsUpdateTime.asMicroseconds() / statsNumFrames) + "us\n" +
+            profiler.flushReport()
         );
         statsUpdateTime -= sf::seconds(1.0f);
         statsNumFrames = 0;
@@ -112,5 +150,6 @@ void Application::registerStates()
     stateStack.registerState<GameState>(StateID::Game);
     stateStack.registerState<PauseState>(StateID::Pause);
     stateStack.registerState<GameOverState>(StateID::GameOver);
+    stateStack.registerState<LoadingState>(StateID::Loading);
     //stateStack.registerState<GexState>(StateID::Gex);
 }
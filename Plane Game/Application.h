@@ -9,11 +9,23 @@
 #include "Player.h"
 #include "MusicPlayer.h"
 #include "SoundPlayer.h"
+#include "ThreadPool.h"
+#include "ResourceLoader.h"
+#include "Profiler.h"
+#include "NetworkSettings.h"
+#include "WorldSnapshot.h"
+
+#include <memory>
 
 class Application
 {
 public:
-							Application();
+	// A non empty replay file starts its mission straight away and plays it back,
+	// so does hosting or joining a co-op game. A snapshot file, such as the
+	// Checkpoint.snap F5 writes, starts the mission from that state.
+	explicit				Application(const std::string& replayFile = std::string(),
+								const NetworkSettings& network = NetworkSettings(),
+								const std::string& snapshotFile = std::string());
 	void					run();
 
 private:
@@ -30,11 +42,16 @@ private:
 
 	//context
 	sf::RenderWindow		window;
+	ThreadPool				workers;
+	ResourceLoader			loader;
 	TextureHolder_t         textures;
 	FontHolder_t			fonts;
 	Player					player;
 	MusicPlayer				music;
 	SoundPlayer				sounds;
+	Profiler				profiler;
+	NetworkSettings			network;
+	std::unique_ptr<WorldSnapshot>	startSnapshot;
 
 	StateStack				stateStack;
 
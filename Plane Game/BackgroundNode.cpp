@@ -0,0 +1,117 @@
+#include "BackgroundNode.h"
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// 0 at the bottom of the fade band, 255 at its top and above
+	sf::Uint8 fadeAlpha(float y, float fadeTop, float fadeBottom)
+	{
+		if (fadeBottom <= fadeTop || y <= fadeTop)
+			return 255;
+		float ratio = (fadeBottom - y) / (fadeBottom - fadeTop);
+		return static_cast<sf::Uint8>(255.f * std::max(ratio, 0.f));
+	}
+}
+
+BackgroundNode::BackgroundNode(float width)
+	: SceneNode()
+	, width(width)
+	, segments()
+	, vertices()
+{
+}
+
+void BackgroundNode::addSegment(const sf::Texture& texture, float top, float bottom, float blend)
+{
+	// The previous segment carries on under the fade
+	if (!segments.empty() && blend > 0.f)
+		segments.back().top -= blend;
+
+	segments.push_back({ &texture, top, bottom, blend });
+}
+
+void BackgroundNode::removeSegmentsBelow(float y)
+{
+	while (!segments.empty() && segments.front().top > y)
+		segments.pop_front();
+}
+
+void BackgroundNode::clearSegments()
+{
+	segments.clear();
+}
+
+std::size_t BackgroundNode::getSegmentCount() const
+{
+	return segments.size();
+}
+
+void BackgroundNode::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	// Visible slice in local coordinates
+	const sf::View& view = target.getView();
+	sf::FloatRect viewRect(view.getCenter() - view.getSize() / 2.f, view.getSize());
+	sf::FloatRect visible = states.transform.getInverse().transformRect(viewRect);
+	float visibleTop = visible.top;
+	float visibleBottom = visible.top + visible.height;
+
+	// Segments are drawn in order so each fades in over the one before
+	for (const Segment& segment : segments)
+	{
+		float top = std::max(segment.top, visibleTop);
+		float bottom = std::min(segment.bottom, visibleBottom);
+		if (top >= bottom)
+			continue;
+
+		vertices.clear();
+		float fadeBottom = segment.bottom;
+		float fadeTop = segment.bottom - segment.blend;
+
+		// Split at the fade band so the vertex alpha ramps exactly across it
+		if (segment.blend > 0.f && fadeTop > top && fadeTop < bottom)
+		{
+			appendTiles(*segment.texture, top, fadeTop, fadeTop, fadeBottom);
+			appendTiles(*segment.texture, fadeTop, bottom, fadeTop, fadeBottom);
+		}
+		else
+		{
+			appendTiles(*segment.texture, top, bottom, fadeTop, fadeBottom);
+		}
+
+		states.texture = segment.texture;
+		target.draw(vertices.data(), vertices.size(), sf::Quads, states);
+	}
+}
+
+void BackgroundNode::appendTiles(const sf::Texture& texture, float top, float bottom, float fadeTop, float fadeBottom) const
+{
+	sf::Vector2f tileSize(texture.getSize());
+
+	// Tiles sit on a grid anchored at the origin, so neighbouring segments and
+	// frames line up without any repeated texture rect
+	float firstRow = std::floor(top / tileSize.y);
+	for (float row = firstRow; row * tileSize.y < bottom; row += 1.f)
+	{
+		float tileTop = row * tileSize.y;
+		float y0 = std::max(tileTop, top);
+		float y1 = std::min(tileTop + tileSize.y, bottom);
+		sf::Color topColor(255, 255, 255, fadeAlpha(y0, fadeTop, fadeBottom));
+		sf::Color bottomColor(255, 255, 255, fadeAlpha(y1, fadeTop, fadeBottom));
+
+		for (float x0 = 0.f; x0 < width; x0 += tileSize.x)
+		{
+			float x1 = std::min(x0 + tileSize.x, width);
+			float u1 = x1 - x0;
+
+			vertices.push_back(sf::Vertex(sf::Vector2f(x0, y0), topColor, sf::Vector2f(0.f, y0 - tileTop)));
+			vertices.push_back(sf::Vertex(sf::Vector2f(x1, y0), topColor, sf::Vector2f(u1, y0 - tileTop)));
+			vertices.push_back(sf::Vertex(sf::Vector2f(x1, y1), bottomColor, sf::Vector2f(u1, y1 - tileTop)));
+			vertices.push_back(sf::Vertex(sf::Vector2f(x0, y1), bottomColor, sf::Vector2f(0.f, y1 - tileTop)));
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "SceneNode.h"
+#include <SFML/Graphics/Vertex.hpp>
+
+#include <deque>
+#include <vector>
+
+namespace sf
+{
+	class Texture;
+}
+
+// Scrolling background made of texture tiles. Only the tiles that intersect
+// the view are emitted each frame, so the cost is the same for any stage
+// length. Segments follow each other upwards. A segment with a blend fades
+// in over the one before it, which extends up under the fade.
+class BackgroundNode : public SceneNode
+{
+public:
+	explicit					BackgroundNode(float width);
+
+	// top < bottom in world coordinates, segments are added bottom to top
+	void						addSegment(const sf::Texture& texture, float top, float bottom, float blend);
+	// Drops segments lying entirely below y
+	void						removeSegmentsBelow(float y);
+	void						clearSegments();
+
+	std::size_t					getSegmentCount() const;
+
+private:
+	virtual void				drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+	void						appendTiles(const sf::Texture& texture, float top, float bottom, float fadeTop, float fadeBottom) const;
+
+private:
+	struct Segment
+	{
+		const sf::Texture*			texture;
+		float						top;
+		float						bottom;
+		float						blend;
+	};
+
+private:
+	float						width;
+	std::deque<Segment>			segments;
+
+	// Rebuilt every draw from the visible slice only
+	mutable std::vector<sf::Vertex>	vertices;
+};
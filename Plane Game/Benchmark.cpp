@@ -0,0 +1,598 @@
+#include "Benchmark.h"
+#include "DataTables.h"
+#include "DataTableWatcher.h"
+#include "WorldSnapshot.h"
+#include "NetworkState.h"
+#include "Headless.h"
+#include "RollbackSession.h"
+#include "CoopSession.h"
+#include "MovementSystem.h"
+#include "Utility.h"
+#include "PostEffect.h"
+#include "StressTest.h"
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+	const std::size_t EntityCount = 1000;
+	const std::size_t TickCount = 10000;
+
+	// Same tables as before the switch to EnumArray, for comparison
+	template <typename Enum, typename Table>
+	auto toMap(const Table& table)
+	{
+		using Data = typename std::decay<decltype(table[Enum()])>::type;
+		std::map<Enum, Data> map;
+		for (std::size_t i = 0; i < Table::size(); ++i)
+			map[static_cast<Enum>(i)] = table[static_cast<Enum>(i)];
+		return map;
+	}
+
+	// The accessors World::update hits per entity and tick: Aircraft::getMaxSpeed,
+	// the movement pattern, checkProjectileLaunch, Projectile::getMaxSpeed/getDamage
+	template <typename AircraftLookup, typename ProjectileLookup>
+	float simulateUpdate(const std::vector<Aircraft::Type>& aircraft, const std::vector<Projectile::Type>& projectiles,
+		AircraftLookup aircraftData, ProjectileLookup projectileData)
+	{
+		float sink = 0.f;
+		for (std::size_t tick = 0; tick < TickCount; ++tick)
+		{
+			for (Aircraft::Type type : aircraft)
+			{
+				const AircraftData& data = aircraftData(type);
+				sink += data.speed;
+				sink += static_cast<float>(data.directions.size());
+				if (data.fireInterval != sf::Time::Zero)
+					sink += data.fireInterval.asSeconds();
+			}
+			for (Projectile::Type type : projectiles)
+			{
+				sink += projectileData(type).speed;
+				sink += static_cast<float>(projectileData(type).damage);
+			}
+		}
+		return sink;
+	}
+
+	void report(const std::string& label, sf::Time time, std::size_t lookups, float sink)
+	{
+		std::cout << label << ": " << time.asMilliseconds() << " ms, "
+			<< (time.asMicroseconds() * 1000.0 / lookups) << " ns/lookup"
+			<< " (checksum " << sink << ")" << std::endl;
+	}
+
+	int benchmarkTables()
+	{
+		DataTableWatcher tables("Media/Data/Entities.txt", "Media/Data/Entities.bin");
+		const AircraftTable& aircraftTable = entityTables().aircraft;
+		const ProjectileTable& projectileTable = entityTables().projectiles;
+		const auto aircraftMap = toMap<Aircraft::Type>(aircraftTable);
+		const auto projectileMap = toMap<Projectile::Type>(projectileTable);
+
+		// Fixed seed so both runs walk the same entities
+		std::mt19937 random(1234);
+		std::vector<Aircraft::Type> aircraft(EntityCount);
+		std::vector<Projectile::Type> projectiles(EntityCount);
+		for (std::size_t i = 0; i < EntityCount; ++i)
+		{
+			aircraft[i] = static_cast<Aircraft::Type>(random() % AircraftTable::size());
+			projectiles[i] = static_cast<Projectile::Type>(random() % ProjectileTable::size());
+		}
+
+		const std::size_t lookups = TickCount * EntityCount * 3;
+		std::cout << "Data table lookups, " << EntityCount << " aircraft and projectiles over " << TickCount << " ticks" << std::endl;
+
+		sf::Clock clock;
+		float sink = simulateUpdate(aircraft, projectiles,
+			[&](Aircraft::Type type) -> const AircraftData& { return aircraftMap.at(type); },
+			[&](Projectile::Type type) -> const ProjectileData& { return projectileMap.at(type); });
+		report("std::map::at", clock.restart(), lookups, sink);
+
+		sink = simulateUpdate(aircraft, projectiles,
+			[&](Aircraft::Type type) -> const AircraftData& { return aircraftTable[type]; },
+			[&](Projectile::Type type) -> const ProjectileData& { return projectileTable[type]; });
+		report("EnumArray", clock.restart(), lookups, sink);
+
+		return 0;
+	}
+
+	// Record layout cost of a busy world; the scene traversal in World::saveSnapshot comes on top
+	int benchmarkSnapshot()
+	{
+		const std::size_t repetitions = 1000;
+
+		WorldSnapshot snapshot;
+		RandomStream random(1234, 0);
+		for (std::size_t i = 0; i < EntityCount; ++i)
+		{
+			float x = random.nextFloat() * 1280.f;
+			float y = random.nextFloat() * 720.f;
+			switch (i % 4)
+			{
+			case 0:
+			case 1:
+				snapshot.aircraft.push_back({ random.split(), 0, 0, 1, 20, x, y, 180.f, 0.f, 80.f, 0.f, 0, 0, 1, 1, 0, 0, 1, 0, -1, 0 });
+				break;
+			case 2:
+				snapshot.projectiles.push_back({ 1, 1, x, y, 0.f, 0.f, 300.f, 0.f, 0.f });
+				break;
+			default:
+				snapshot.pickups.push_back({ 0, 1, x, y, 0.f, 1.f });
+				break;
+			}
+		}
+
+		std::vector<char> buffer;
+		WorldSnapshot restored;
+		std::cout << "Snapshot of " << EntityCount << " entities, " << repetitions << " repetitions" << std::endl;
+
+		sf::Clock clock;
+		for (std::size_t i = 0; i < repetitions; ++i)
+			snapshot.writeTo(buffer);
+		sf::Time writeTime = clock.restart();
+		for (std::size_t i = 0; i < repetitions; ++i)
+			restored.readFrom(buffer.data(), buffer.size());
+		sf::Time readTime = clock.restart();
+
+		std::cout << "writeTo: " << writeTime.asMicroseconds() / static_cast<sf::Int64>(repetitions) << " us, "
+			<< "readFrom: " << readTime.asMicroseconds() / static_cast<sf::Int64>(repetitions) << " us, "
+			<< buffer.size() << " bytes" << std::endl;
+
+		// The same through a World, walking and rebuilding the scene graph
+		const std::size_t worldRepetitions = 100;
+		HeadlessWorld headless;
+		World& world = headless.getWorld();
+		seedRandom(1234);
+		headless.finishLoading();
+
+		StressScenario scenario;
+		scenario.enemies = EntityCount * 2 / 5;
+		scenario.bullets = EntityCount / 2;
+		scenario.missiles = EntityCount / 50;
+		scenario.pickups = EntityCount * 2 / 25;
+		WorldSnapshot populated;
+		world.saveSnapshot(populated);
+		generateStressScene(scenario, 1.f, sf::Vector2f(1280.f, 720.f), populated);
+		world.restoreSnapshot(populated);
+
+		WorldSnapshot saved;
+		clock.restart();
+		for (std::size_t i = 0; i < worldRepetitions; ++i)
+			world.saveSnapshot(saved);
+		sf::Time saveTime = clock.restart();
+		for (std::size_t i = 0; i < worldRepetitions; ++i)
+			world.restoreSnapshot(saved);
+		sf::Time restoreTime = clock.restart();
+
+		std::size_t worldEntities = saved.aircraft.size() + saved.projectiles.size() + saved.pickups.size();
+		std::cout << "World of " << worldEntities << " entities, " << worldRepetitions << " repetitions" << std::endl;
+		std::cout << "saveSnapshot: " << saveTime.asMicroseconds() / static_cast<sf::Int64>(worldRepetitions) << " us, "
+			<< "restoreSnapshot: " << restoreTime.asMicroseconds() / static_cast<sf::Int64>(worldRepetitions) << " us" << std::endl;
+
+		bool roundTrip = restored.aircraft.size() == snapshot.aircraft.size();
+		bool worldRoundTrip = worldEntities == populated.aircraft.size() + populated.projectiles.size() + populated.pickups.size();
+		return roundTrip && worldRoundTrip ? 0 : 1;
+	}
+
+	// Worst case rollback frame on a busy stage: restore the state from
+	// MaxRollback ticks ago, simulate those ticks again, then the new one
+	int benchmarkRollback()
+	{
+		const std::uint32_t warmupTicks = 40 * 60;
+		const std::uint32_t frames = 300;
+		const std::uint32_t depth = RollbackSession::MaxRollback;
+		const Replay::ActionMask fire = static_cast<Replay::ActionMask>(1u << static_cast<int>(Player::Action::Fire));
+
+		HeadlessWorld headless;
+		World& world = headless.getWorld();
+		seedRandom(1234);
+		headless.finishLoading();
+		world.addAircraft(CoopSession::ClientIdentifier);
+
+		// Both players fire all the time and wander, the same way when a tick runs again
+		Player host(CoopSession::HostIdentifier);
+		Player client(CoopSession::ClientIdentifier);
+		auto step = [&](std::uint32_t tick)
+		{
+			RandomStream script(tick / 20, 0);
+			host.pushActions(static_cast<Replay::ActionMask>(script.nextInt(16)) | fire, world.getCommands());
+			client.pushActions(static_cast<Replay::ActionMask>(script.nextInt(16)) | fire, world.getCommands());
+			world.update(HeadlessWorld::TimePerFrame);
+		};
+
+		std::uint32_t tick = 0;
+		for (; tick < warmupTicks; ++tick)
+			step(tick);
+
+		std::array<WorldSnapshot, depth + 1> snapshots;
+		for (std::uint32_t i = 0; i < depth; ++i, ++tick)
+		{
+			world.saveSnapshot(snapshots[tick % snapshots.size()]);
+			step(tick);
+		}
+
+		sf::Time saveTime, restoreTime, updateTime, worstFrame, totalFrames;
+		sf::Clock frameClock, clock;
+		for (std::uint32_t frame = 0; frame < frames; ++frame, ++tick)
+		{
+			frameClock.restart();
+
+			clock.restart();
+			world.restoreSnapshot(snapshots[(tick - depth) % snapshots.size()]);
+			restoreTime += clock.getElapsedTime();
+
+			for (std::uint32_t t = tick - depth; t <= tick; ++t)
+			{
+				world.setResimulating(t < tick);
+				clock.restart();
+				world.saveSnapshot(snapshots[t % snapshots.size()]);
+				saveTime += clock.restart();
+				step(t);
+				updateTime += clock.getElapsedTime();
+			}
+
+			sf::Time frameTime = frameClock.getElapsedTime();
+			worstFrame = std::max(worstFrame, frameTime);
+			totalFrames += frameTime;
+		}
+
+		// Rolling back must not change the outcome: the same ticks again from
+		// an older state have to end where they did
+		WorldSnapshot current, resimulated;
+		std::vector<char> currentData, resimulatedData;
+		world.saveSnapshot(current);
+		world.restoreSnapshot(snapshots[(tick - depth) % snapshots.size()]);
+		for (std::uint32_t t = tick - depth; t < tick; ++t)
+			step(t);
+		world.saveSnapshot(resimulated);
+		current.writeTo(currentData);
+		resimulated.writeTo(resimulatedData);
+		bool deterministic = currentData == resimulatedData;
+
+		const WorldSnapshot& busy = snapshots[(tick - 1) % snapshots.size()];
+		const sf::Int64 ticks = static_cast<sf::Int64>(frames) * (depth + 1);
+		std::cout << busy.aircraft.size() << " aircraft, " << busy.projectiles.size() << " projectiles, "
+			<< busy.pickups.size() << " pickups after " << warmupTicks << " ticks\n"
+			<< frames << " frames rolling back " << depth << " ticks: "
+			<< totalFrames.asMicroseconds() / frames << " us average, " << worstFrame.asMicroseconds() << " us worst, "
+			<< "budget " << HeadlessWorld::TimePerFrame.asMicroseconds() << " us\n"
+			<< "restore " << restoreTime.asMicroseconds() / frames << " us, save "
+			<< saveTime.asMicroseconds() / ticks << " us, update " << updateTime.asMicroseconds() / ticks << " us per tick\n"
+			<< (deterministic ? "resimulated state matches" : "resimulated state differs") << std::endl;
+
+		return deterministic && worstFrame < HeadlessWorld::TimePerFrame ? 0 : 1;
+	}
+
+	// Co-op state stream for a busy battlefield: 20 states per second, 10% of
+	// the states and of the acknowledgements lost, as CoopSession sends them
+	int benchmarkNetState()
+	{
+		const std::size_t entityCount = 500;
+		const std::uint32_t seconds = 30;
+		const std::uint32_t sendInterval = 3;
+		const std::size_t headerSize = 28 + 9;
+		const float dt = 1.f / NetworkTicksPerSecond;
+
+		struct SimulatedEntity
+		{
+			float			x, y, vx, vy;
+			int				hitpoints;
+			std::uint8_t	kind;
+		};
+
+		RandomStream random(1234, 0);
+		std::map<std::uint32_t, SimulatedEntity> entities;
+		std::uint32_t nextId = 1;
+		auto spawn = [&](std::uint8_t kind)
+		{
+			SimulatedEntity entity = { random.nextFloat() * 1280.f, random.nextFloat() * 4000.f, 0.f, 0.f, 20, kind };
+			if (kind == NetworkEntity::Aircraft)
+				entity.vx = 80.f, entity.vy = -50.f;
+			else if (kind == NetworkEntity::Projectile)
+				entity.vy = 300.f;
+			entities[nextId++] = entity;
+		};
+		for (std::size_t i = 0; i < entityCount; ++i)
+			spawn(i % 10 < 6 ? NetworkEntity::Projectile : (i % 10 < 9 ? NetworkEntity::Aircraft : NetworkEntity::Pickup));
+
+		std::map<std::uint32_t, NetworkState> sentStates;
+		std::map<std::uint32_t, NetworkState> receivedStates;
+		std::uint32_t acked = 0;
+		bool hasAck = false;
+		std::size_t bytes = 0;
+		std::size_t packets = 0;
+		std::vector<char> payload;
+		sf::Time encodeTime;
+		sf::Clock clock;
+
+		for (std::uint32_t tick = 1; tick <= seconds * NetworkTicksPerSecond; ++tick)
+		{
+			// Aircraft weave and take hits, a bullet is replaced every 12 ticks
+			for (auto& pair : entities)
+			{
+				SimulatedEntity& entity = pair.second;
+				entity.x += entity.vx * dt;
+				entity.y += entity.vy * dt;
+				if (entity.kind == NetworkEntity::Aircraft && random.nextInt(120) == 0)
+					entity.vx = -entity.vx;
+				if (entity.kind == NetworkEntity::Aircraft && random.nextInt(600) == 0)
+					entity.hitpoints -= 10;
+			}
+			if (tick % 12 == 0)
+			{
+				entities.erase(entities.begin());
+				spawn(NetworkEntity::Projectile);
+			}
+			if (tick % sendInterval != 0)
+				continue;
+
+			NetworkState current;
+			current.tick = tick;
+			current.viewY = quantizePosition(4000.f - tick * 1.6f);
+			for (const auto& pair : entities)
+			{
+				const SimulatedEntity& entity = pair.second;
+				current.entities.push_back({ pair.first, entity.kind, 1, 0, 0,
+					quantizePosition(entity.x), quantizePosition(entity.y),
+					quantizePosition(entity.vx), quantizePosition(entity.vy), entity.hitpoints });
+			}
+
+			NetworkState sent;
+			clock.restart();
+			encodeState(current, hasAck ? &sentStates[acked] : nullptr, payload, sent);
+			encodeTime += clock.getElapsedTime();
+			sentStates[tick] = sent;
+			bytes += payload.size() + headerSize;
+			packets += 1;
+
+			if (random.nextInt(10) == 0)
+				continue;
+
+			NetworkState received;
+			if (!decodeState(payload.data(), payload.size(), hasAck ? &receivedStates[acked] : nullptr, received)
+				|| received.entities.size() != sent.entities.size())
+			{
+				std::cout << "Decoded state does not match at tick " << tick << std::endl;
+				return 1;
+			}
+			receivedStates[tick] = received;
+			if (random.nextInt(10) != 0)
+			{
+				acked = tick;
+				hasAck = true;
+			}
+		}
+
+		std::cout << entityCount << " entities, " << packets << " states over " << seconds << " s: "
+			<< bytes / packets << " bytes per state, " << bytes * 8.f / seconds / 1000.f << " kbps with UDP/IP headers, "
+			<< encodeTime.asMicroseconds() / static_cast<sf::Int64>(packets) << " us per encode" << std::endl;
+		return 0;
+	}
+
+	// What each aircraft did in its own update before the movement system
+	struct LegacyPattern
+	{
+		Aircraft::Type	type;
+		float			travelledDistance;
+		std::size_t		directionIndex;
+		sf::Vector2f	velocity;
+	};
+
+	void updateLegacyPattern(LegacyPattern& aircraft, float dt)
+	{
+		const AircraftData& data = entityTables().aircraft[aircraft.type];
+		const std::vector<Direction>& directions = data.directions;
+		if (directions.empty())
+			return;
+
+		if (aircraft.directionIndex >= directions.size())
+			aircraft.directionIndex = 0;
+		if (aircraft.travelledDistance > directions[aircraft.directionIndex].distance)
+		{
+			aircraft.directionIndex = (aircraft.directionIndex + 1) % directions.size();
+			aircraft.travelledDistance = 0.f;
+		}
+
+		float radians = toRadian(directions[aircraft.directionIndex].angle + 90.f);
+		aircraft.velocity = sf::Vector2f(data.speed * std::cos(radians), data.speed * std::sin(radians));
+		aircraft.travelledDistance += data.speed * dt;
+	}
+
+	// Enemy pattern movement for a crowded screen, per aircraft virtual update
+	// with trigonometry against the batched pass over precomputed headings,
+	// then the batched pass with everyone on a flight path
+	int benchmarkMovement()
+	{
+		const std::size_t aircraftCount = 10000;
+		const std::size_t ticks = 600;
+		const sf::Time dt = sf::seconds(1.f / 60.f);
+
+		DataTableWatcher tables("Media/Data/Entities.txt", "Media/Data/Entities.bin");
+
+		RandomStream random(1234, 0);
+		std::vector<LegacyPattern> legacy(aircraftCount);
+		MovementSystem system;
+		// Owners must not move while they hold a slot
+		std::vector<std::size_t> slots(aircraftCount);
+		for (std::size_t i = 0; i < aircraftCount; ++i)
+		{
+			Aircraft::Type type = (i % 2 == 0) ? Aircraft::Type::Raptor : Aircraft::Type::Avenger;
+			float travelled = random.nextFloat() * 100.f;
+			legacy[i] = { type, travelled, 0, sf::Vector2f() };
+			system.add(type, travelled, 0, slots[i]);
+		}
+
+		std::cout << "Movement patterns of " << aircraftCount << " aircraft over " << ticks << " ticks" << std::endl;
+
+		sf::Clock clock;
+		for (std::size_t tick = 0; tick < ticks; ++tick)
+		{
+			for (LegacyPattern& aircraft : legacy)
+				updateLegacyPattern(aircraft, dt.asSeconds());
+		}
+		sf::Time legacyTime = clock.restart();
+
+		for (std::size_t tick = 0; tick < ticks; ++tick)
+			system.update(dt);
+		sf::Time batchedTime = clock.restart();
+
+		// Same arithmetic in the same order, so both end up in the same place
+		float legacySum = 0.f;
+		float batchedSum = 0.f;
+		std::size_t mismatches = 0;
+		for (std::size_t i = 0; i < aircraftCount; ++i)
+		{
+			legacySum += legacy[i].travelledDistance;
+			batchedSum += system.getTravelledDistance(slots[i]);
+			if (legacy[i].directionIndex != system.getDirectionIndex(slots[i]))
+				mismatches += 1;
+		}
+
+		std::cout << "Per aircraft: " << legacyTime.asMicroseconds() / static_cast<sf::Int64>(ticks) << " us per tick"
+			<< " (checksum " << legacySum << ")" << std::endl;
+		std::cout << "Batched: " << batchedTime.asMicroseconds() / static_cast<sf::Int64>(ticks) << " us per tick"
+			<< " (checksum " << batchedSum << ")" << std::endl;
+
+		if (mismatches != 0)
+		{
+			std::cout << mismatches << " aircraft are on a different step" << std::endl;
+			return 1;
+		}
+
+		// The same aircraft on one shared flight path, each at its own distance
+		const FlightPath path({ { 0.f, 0.f }, { 150.f, 120.f }, { -150.f, 360.f }, { 150.f, 600.f }, { 0.f, 720.f } });
+		for (Aircraft::Type type : { Aircraft::Type::Raptor, Aircraft::Type::Avenger })
+		{
+			entityTables().aircraft[type].directions.clear();
+			entityTables().aircraft[type].path = path;
+		}
+		system.rebuildPatterns();
+
+		clock.restart();
+		for (std::size_t tick = 0; tick < ticks; ++tick)
+			system.update(dt);
+		sf::Time pathTime = clock.restart();
+
+		sf::Vector2f velocitySum;
+		for (std::size_t slot : slots)
+			velocitySum += system.getVelocity(slot);
+		std::cout << "Flight path of " << path.getLength() << " px: " << pathTime.asMicroseconds() / static_cast<sf::Int64>(ticks) << " us per tick"
+			<< " (checksum " << velocitySum.x + velocitySum.y << ")" << std::endl;
+		return 0;
+	}
+
+	// The CPU bloom against the shader chain on the same frame of the level.
+	// The shaders blur 8 bit textures with bilinear taps, the CPU floats, so
+	// they may differ by a few levels but not visibly.
+	int benchmarkBloom()
+	{
+		const double maxTolerance = 24.0;
+		const double meanTolerance = 2.0;
+		const std::uint32_t ticks = 5 * 60;
+
+		HeadlessWorld headless;
+		World& world = headless.getWorld();
+		seedRandom(1234);
+		headless.finishLoading();
+
+		if (!PostEffect::isSupported())
+		{
+			std::cout << "Shaders are not supported here, there is no shader bloom to compare with" << std::endl;
+			return 1;
+		}
+
+		// A few seconds in, so enemies, bullets and smoke are on screen
+		Player player;
+		const Replay::ActionMask fire = static_cast<Replay::ActionMask>(1u << static_cast<int>(Player::Action::Fire));
+		for (std::uint32_t tick = 0; tick < ticks; ++tick)
+		{
+			player.pushActions(fire, world.getCommands());
+			world.update(HeadlessWorld::TimePerFrame);
+		}
+		world.setBloomQuality(BloomEffect::Quality::High);
+
+		sf::Clock clock;
+		world.draw();
+		headless.display();
+		sf::Image shaderImage = headless.copyImage();
+		sf::Time shaderTime = clock.restart();
+
+		sf::Image softwareImage;
+		world.capture(softwareImage);
+		sf::Time softwareTime = clock.restart();
+
+		sf::Vector2u size = shaderImage.getSize();
+		if (softwareImage.getSize() != size)
+		{
+			std::cout << "The two paths rendered different sizes" << std::endl;
+			return 1;
+		}
+
+		// Colour channels only, alpha is always opaque
+		const sf::Uint8* shaderPixels = shaderImage.getPixelsPtr();
+		const sf::Uint8* softwarePixels = softwareImage.getPixelsPtr();
+		const std::size_t pixelCount = static_cast<std::size_t>(size.x) * size.y;
+		int maxDifference = 0;
+		double totalDifference = 0.0;
+		for (std::size_t i = 0; i < pixelCount; ++i)
+		{
+			for (std::size_t channel = 0; channel < 3; ++channel)
+			{
+				int difference = std::abs(shaderPixels[i * 4 + channel] - softwarePixels[i * 4 + channel]);
+				maxDifference = std::max(maxDifference, difference);
+				totalDifference += difference;
+			}
+		}
+		double meanDifference = totalDifference / (pixelCount * 3);
+
+		std::cout << "Bloom on a " << size.x << "x" << size.y << " frame: shader " << shaderTime.asMicroseconds()
+			<< " us with readback, software " << softwareTime.asMicroseconds() << " us with scene readback" << std::endl;
+		std::cout << "Per channel difference in levels of 255: max " << maxDifference << " (tolerance " << maxTolerance
+			<< "), mean " << meanDifference << " (tolerance " << meanTolerance << ")" << std::endl;
+
+		if (maxDifference > maxTolerance || meanDifference > meanTolerance)
+		{
+			std::cout << "The software bloom does not match the shaders" << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+}
+
+int runBenchmark(const std::string& name)
+{
+	const std::map<std::string, std::function<int()>> benchmarks =
+	{
+		{ "tables", benchmarkTables },
+		{ "snapshot", benchmarkSnapshot },
+		{ "netstate", benchmarkNetState },
+		{ "rollback", benchmarkRollback },
+		{ "movement", benchmarkMovement },
+		{ "bloom", benchmarkBloom },
+	};
+
+	auto found = benchmarks.find(name);
+	if (found == benchmarks.end())
+	{
+		std::cout << "Unknown benchmark \"" << name << "\", available:";
+		for (const auto& benchmark : benchmarks)
+			std::cout << " " << benchmark.first;
+		std::cout << std::endl;
+		return 1;
+	}
+
+	return found->second();
+}
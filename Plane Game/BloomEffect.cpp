@@ -1,42 +1,117 @@
 #include "BloomEffect.h"
-BloomEffect::BloomEffect()
+#include "RenderTexturePool.h"
+
+#include <SFML/Graphics/Sprite.hpp>
+
+BloomEffect::BloomEffect(ResourceLoader& loader)
 	: shaders()
-	, brightnessTexture()
-	, firstPassTextures()
-	, secondPassTextures()
+	, quality(Quality::High)
+	, frameCounter(0)
+	, cachedBloom(nullptr)
+	, cachePool(nullptr)
 {
-	shaders.load(ShaderID::BrightnessPass, "Media/Shaders/Fullpass.vert", "Media/Shaders/Brightness.frag");
-	shaders.load(ShaderID::DownSamplePass, "Media/Shaders/Fullpass.vert", "Media/Shaders/DownSample.frag");
-	shaders.load(ShaderID::GaussianBlurPass, "Media/Shaders/Fullpass.vert", "Media/Shaders/GuassianBlur.frag");
-	shaders.load(ShaderID::AddPass, "Media/Shaders/Fullpass.vert", "Media/Shaders/Add.frag");
+	shaders.loadAsync(ShaderID::BrightnessPass, "Media/Shaders/Fullpass.vert", "Media/Shaders/Brightness.frag", loader);
+	shaders.loadAsync(ShaderID::DownSamplePass, "Media/Shaders/Fullpass.vert", "Media/Shaders/DownSample.frag", loader);
+	shaders.loadAsync(ShaderID::GaussianBlurPass, "Media/Shaders/Fullpass.vert", "Media/Shaders/GuassianBlur.frag", loader);
+	shaders.loadAsync(ShaderID::LinearBlurPass, "Media/Shaders/Fullpass.vert", "Media/Shaders/LinearBlur.frag", loader);
+	shaders.loadAsync(ShaderID::AddPass, "Media/Shaders/Fullpass.vert", "Media/Shaders/Add.frag", loader);
 }
-void BloomEffect::apply(const sf::RenderTexture& input, sf::RenderTarget& output)
+void BloomEffect::apply(const sf::RenderTexture& input, sf::RenderTarget& output, RenderTexturePool& pool)
 {
-	prepareTextures(input.getSize());
-	filterBright(input, brightnessTexture);
-	downsample(brightnessTexture, firstPassTextures[0]);
-	blurMultipass(firstPassTextures);
-	downsample(firstPassTextures[0], secondPassTextures[0]);
-	blurMultipass(secondPassTextures);
-	add(firstPassTextures[0], secondPassTextures[0], firstPassTextures[1]);
-	firstPassTextures[1].display();
-	add(input, firstPassTextures[1], output);
+	// Give back the cached bloom once it is stale
+	if (cachedBloom && cachedBloom->getSize() != input.getSize() / 4u)
+		releaseCachedBloom();
+
+	switch (quality)
+	{
+	case Quality::High:
+		applyHigh(input, output, pool);
+		break;
+	case Quality::Low:
+		applyLow(input, output, pool);
+		break;
+	default:
+		output.draw(sf::Sprite(input.getTexture()), sf::BlendNone);
+		break;
+	}
 }
-void BloomEffect::prepareTextures(sf::Vector2u size)
+bool BloomEffect::isEnabled() const
 {
-	if (brightnessTexture.getSize() != size)
+	return quality != Quality::Off;
+}
+std::string BloomEffect::getName() const
+{
+	return quality == Quality::High ? "Bloom (high)" : "Bloom (low)";
+}
+void BloomEffect::setQuality(Quality q)
+{
+	// Off skips apply altogether, so the texture cannot wait for it
+	if (q != Quality::Low)
+		releaseCachedBloom();
+	quality = q;
+}
+BloomEffect::Quality BloomEffect::getQuality() const
+{
+	return quality;
+}
+void BloomEffect::releaseCachedBloom()
+{
+	if (!cachedBloom)
+		return;
+
+	cachePool->release(*cachedBloom);
+	cachedBloom = nullptr;
+	cachePool = nullptr;
+}
+void BloomEffect::applyHigh(const sf::RenderTexture& input, sf::RenderTarget& output, RenderTexturePool& pool)
+{
+	sf::Vector2u size = input.getSize();
+
+	sf::RenderTexture& brightness = pool.acquire(size);
+	sf::RenderTexture& firstPass = pool.acquire(size / 2u);
+	sf::RenderTexture& firstScratch = pool.acquire(size / 2u);
+	filterBright(input, brightness);
+	downsample(brightness, firstPass);
+	pool.release(brightness);
+	blurMultipass(firstPass, firstScratch);
+
+	sf::RenderTexture& secondPass = pool.acquire(size / 4u);
+	sf::RenderTexture& secondScratch = pool.acquire(size / 4u);
+	downsample(firstPass, secondPass);
+	blurMultipass(secondPass, secondScratch);
+
+	add(firstPass, secondPass, firstScratch);
+	firstScratch.display();
+	add(input, firstScratch, output);
+
+	pool.release(firstPass);
+	pool.release(firstScratch);
+	pool.release(secondPass);
+	pool.release(secondScratch);
+}
+void BloomEffect::applyLow(const sf::RenderTexture& input, sf::RenderTarget& output, RenderTexturePool& pool)
+{
+	// Bright pass straight to half resolution, one blur at quarter resolution
+	if (!cachedBloom || frameCounter % 2 == 0)
 	{
-		brightnessTexture.create(size.x, size.y);
-		brightnessTexture.setSmooth(true);
-		firstPassTextures[0].create(size.x / 2, size.y / 2);
-		firstPassTextures[0].setSmooth(true);
-		firstPassTextures[1].create(size.x / 2, size.y / 2);
-		firstPassTextures[1].setSmooth(true);
-		secondPassTextures[0].create(size.x / 4, size.y / 4);
-		secondPassTextures[0].setSmooth(true);
-		secondPassTextures[1].create(size.x / 4, size.y / 4);
-		secondPassTextures[1].setSmooth(true);
+		sf::Vector2u size = input.getSize();
+		if (!cachedBloom)
+		{
+			cachedBloom = &pool.acquire(size / 4u);
+			cachePool = &pool;
+		}
+
+		sf::RenderTexture& brightness = pool.acquire(size / 2u);
+		sf::RenderTexture& scratch = pool.acquire(size / 4u);
+		filterBright(input, brightness);
+		downsample(brightness, *cachedBloom);
+		blurLinear(*cachedBloom, scratch);
+		pool.release(brightness);
+		pool.release(scratch);
 	}
+	frameCounter += 1;
+
+	add(input, *cachedBloom, output);
 }
 void BloomEffect::filterBright(const sf::RenderTexture& input, sf::RenderTexture& output)
 {
@@ -45,18 +120,24 @@ void BloomEffect::filterBright(const sf::RenderTexture& input, sf::RenderTexture
 	applyShader(brightness, output);
 	output.display();
 }
-void BloomEffect::blurMultipass(RenderTextureArray& renderTextures)
+void BloomEffect::blurMultipass(sf::RenderTexture& texture, sf::RenderTexture& scratch)
 {
-	sf::Vector2u textureSize = renderTextures[0].getSize();
+	sf::Vector2u textureSize = texture.getSize();
 	for (std::size_t count = 0; count < 2; ++count)
 	{
-		blur(renderTextures[0], renderTextures[1], sf::Vector2f(0.f, 1.f / textureSize.y));
-		blur(renderTextures[1], renderTextures[0], sf::Vector2f(1.f / textureSize.x, 0.f));
+		blur(texture, scratch, sf::Vector2f(0.f, 1.f / textureSize.y), ShaderID::GaussianBlurPass);
+		blur(scratch, texture, sf::Vector2f(1.f / textureSize.x, 0.f), ShaderID::GaussianBlurPass);
 	}
 }
-void BloomEffect::blur(const sf::RenderTexture& input, sf::RenderTexture& output, sf::Vector2f offsetFactor)
+void BloomEffect::blurLinear(sf::RenderTexture& texture, sf::RenderTexture& scratch)
+{
+	sf::Vector2u textureSize = texture.getSize();
+	blur(texture, scratch, sf::Vector2f(0.f, 1.f / textureSize.y), ShaderID::LinearBlurPass);
+	blur(scratch, texture, sf::Vector2f(1.f / textureSize.x, 0.f), ShaderID::LinearBlurPass);
+}
+void BloomEffect::blur(const sf::RenderTexture& input, sf::RenderTexture& output, sf::Vector2f offsetFactor, ShaderID pass)
 {
-	sf::Shader& gaussianBlur = shaders.get(ShaderID::GaussianBlurPass);
+	sf::Shader& gaussianBlur = shaders.get(pass);
 	gaussianBlur.setUniform("source", input.getTexture());
 	gaussianBlur.setUniform("offsetFactor", offsetFactor);
 	applyShader(gaussianBlur, output);
@@ -76,4 +157,4 @@ void BloomEffect::add(const sf::RenderTexture& source, const sf::RenderTexture&
 	adder.setUniform("source", source.getTexture());
 	adder.setUniform("bloom", bloom.getTexture());
 	applyShader(adder, output);
-}
\ No newline at end of file
+}
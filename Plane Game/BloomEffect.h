@@ -6,29 +6,46 @@
 #include <SFML/Graphics/RenderTexture.hpp>
 #include <SFML/Graphics/Shader.hpp>
 
-#include <array>
-
 class BloomEffect :public PostEffect
 {
 public:
+	enum class Quality
+	{
+		Off,
+		Low,
+		High,
+		QualityCount
+	};
 
-	BloomEffect();
-	virtual void		apply(const sf::RenderTexture& input, sf::RenderTarget& output) override;
-private:
-	using RenderTextureArray = std::array<sf::RenderTexture, 2>;
+public:
+
+	explicit			BloomEffect(ResourceLoader& loader);
+	virtual void		apply(const sf::RenderTexture& input, sf::RenderTarget& output, RenderTexturePool& pool) override;
+	virtual bool		isEnabled() const override;
+	virtual std::string	getName() const override;
+
+	void				setQuality(Quality q);
+	Quality				getQuality() const;
 
 private:
-	void				prepareTextures(sf::Vector2u size);
+	void				releaseCachedBloom();
+	void				applyHigh(const sf::RenderTexture& input, sf::RenderTarget& output, RenderTexturePool& pool);
+	void				applyLow(const sf::RenderTexture& input, sf::RenderTarget& output, RenderTexturePool& pool);
+
 	void				filterBright(const sf::RenderTexture& input, sf::RenderTexture& output);
-	void				blurMultipass(RenderTextureArray& renderTextures);
-	void				blur(const sf::RenderTexture& input, sf::RenderTexture& output, sf::Vector2f offsetFactor);
+	void				blurMultipass(sf::RenderTexture& texture, sf::RenderTexture& scratch);
+	void				blurLinear(sf::RenderTexture& texture, sf::RenderTexture& scratch);
+	void				blur(const sf::RenderTexture& input, sf::RenderTexture& output, sf::Vector2f offsetFactor, ShaderID pass);
 	void				downsample(const sf::RenderTexture& input, sf::RenderTexture& output);
 	void				add(const sf::RenderTexture& source, const sf::RenderTexture& bloom, sf::RenderTarget& target);
 private:
 	ShaderHolder_t		shaders;
+	Quality				quality;
 
-	sf::RenderTexture	brightnessTexture;
-	RenderTextureArray	firstPassTextures;
-	RenderTextureArray	secondPassTextures;
+	// Low quality refreshes its bloom every other frame, keeping the
+	// result in a pooled texture it holds on to between frames, given back
+	// to its pool as soon as the quality changes
+	std::size_t			frameCounter;
+	sf::RenderTexture*	cachedBloom;
+	RenderTexturePool*	cachePool;
 };
-
@@ -0,0 +1,392 @@
+#include "CoopSession.h"
+#include "World.h"
+#include "Profiler.h"
+
+namespace
+{
+	enum PacketType : std::uint8_t
+	{
+		Hello,
+		Welcome,
+		Input,
+		State,
+		Disconnect,
+	};
+
+	const std::uint32_t NoSequence = 0xffffffff;
+
+	// 20 states per second, the client extrapolates in between
+	const std::uint32_t SendInterval = 3;
+	// Sent and received states kept as delta baselines, 1.6 s at 20 Hz
+	const std::size_t HistorySize = 32;
+	const sf::Time Timeout = sf::seconds(5.f);
+	const sf::Time HelloInterval = sf::seconds(0.5f);
+	// No acknowledgement for these, so they go out a few times
+	const int DisconnectRepeats = 3;
+
+	const std::size_t InputPacketSize = 1 + 4 + 4 + 4;
+	const std::size_t StateHeaderSize = 1 + 4 + 4;
+
+	void writeUint32(std::vector<char>& packet, std::uint32_t value)
+	{
+		for (int i = 0; i < 4; ++i)
+			packet.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+	}
+
+	std::uint32_t readUint32(const std::vector<char>& packet, std::size_t offset)
+	{
+		std::uint32_t value = 0;
+		for (int i = 0; i < 4; ++i)
+			value |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(packet[offset + i])) << (8 * i);
+		return value;
+	}
+}
+
+CoopSession::CoopSession(const NetworkSettings& settings, Profiler& profiler)
+	: settings(settings)
+	, profiler(profiler)
+	, link(settings.role == NetworkSettings::Role::Host ? settings.port : static_cast<unsigned short>(sf::Socket::AnyPort))
+	, peerAddress(settings.role == NetworkSettings::Role::Client ? settings.hostAddress : sf::IpAddress::None)
+	, peerPort(settings.role == NetworkSettings::Role::Client ? settings.port : 0)
+	, connected(false)
+	, ended(false)
+	, disconnected(false)
+	, missionStatus(Player::MissionStatus::Running)
+	, sinceHeard()
+	, sinceHello()
+	, tick(0)
+	, packet()
+	, stateSequence(0)
+	, sentStates()
+	, ackedSequence(NoSequence)
+	, hasAck(false)
+	, currentState()
+	, payload()
+	, lastInputTick(0)
+	, heldActions(0)
+	, pendingActions(0)
+	, recentActions()
+	, receivedStates()
+	, receivedSequence(NoSequence)
+	, hasState(false)
+	, statisticsClock()
+	, statisticsBytes(0)
+{
+	link.setConditions(settings.lossRate, settings.latency, settings.jitter);
+	recentActions.fill(0);
+	if (!isHost())
+		sendToPeer({ static_cast<char>(Hello) });
+}
+
+CoopSession::~CoopSession()
+{
+	disconnect(Player::MissionStatus::Running);
+}
+
+bool CoopSession::isHost() const
+{
+	return settings.role == NetworkSettings::Role::Host;
+}
+
+bool CoopSession::isConnected() const
+{
+	return connected;
+}
+
+bool CoopSession::hasEnded() const
+{
+	return ended;
+}
+
+Player::MissionStatus CoopSession::getMissionStatus() const
+{
+	// A host that quit mid mission counts as a failure
+	if (missionStatus == Player::MissionStatus::Running)
+		return Player::MissionStatus::Failure;
+	return missionStatus;
+}
+
+void CoopSession::updateHost(World& world, Player& remotePlayer)
+{
+	link.update();
+	receiveAsHost(world);
+
+	if (connected && sinceHeard.getElapsedTime() > Timeout)
+	{
+		world.removeAircraft(ClientIdentifier);
+		connected = false;
+	}
+
+	if (connected)
+	{
+		// Held keys repeat until the client says otherwise, presses apply once
+		remotePlayer.pushActions(heldActions | pendingActions, world.getCommands());
+		pendingActions = 0;
+
+		if (tick % SendInterval == 0)
+			sendState(world);
+	}
+
+	tick += 1;
+	updateStatistics();
+}
+
+void CoopSession::updateClient(World& world, Replay::ActionMask actions)
+{
+	link.update();
+	receiveAsClient(world);
+
+	if (!ended && sinceHeard.getElapsedTime() > Timeout)
+	{
+		ended = true;
+		missionStatus = Player::MissionStatus::Failure;
+	}
+	if (ended)
+		return;
+
+	if (!connected)
+	{
+		if (sinceHello.getElapsedTime() >= HelloInterval)
+		{
+			sendToPeer({ static_cast<char>(Hello) });
+			sinceHello.restart();
+		}
+		return;
+	}
+
+	// Each packet repeats the last few ticks, so a lost one loses no presses
+	tick += 1;
+	for (std::size_t i = recentActions.size() - 1; i > 0; --i)
+		recentActions[i] = recentActions[i - 1];
+	recentActions[0] = actions;
+
+	packet.clear();
+	packet.push_back(static_cast<char>(Input));
+	writeUint32(packet, tick);
+	writeUint32(packet, hasState ? receivedSequence : NoSequence);
+	for (Replay::ActionMask mask : recentActions)
+		packet.push_back(static_cast<char>(mask));
+	sendToPeer(packet);
+
+	updateStatistics();
+}
+
+void CoopSession::disconnect(Player::MissionStatus status)
+{
+	if (disconnected)
+		return;
+	disconnected = true;
+
+	if (isHost() && !connected)
+		return;
+
+	for (int i = 0; i < DisconnectRepeats; ++i)
+		sendToPeer({ static_cast<char>(Disconnect), static_cast<char>(status) });
+	link.flush();
+}
+
+void CoopSession::receiveAsHost(World& world)
+{
+	std::vector<char> data;
+	sf::IpAddress address;
+	unsigned short port = 0;
+
+	while (link.receive(data, address, port))
+	{
+		if (data.empty())
+			continue;
+
+		bool fromPeer = connected && address == peerAddress && port == peerPort;
+		switch (static_cast<std::uint8_t>(data[0]))
+		{
+		case Hello:
+			if (!connected && !disconnected)
+			{
+				peerAddress = address;
+				peerPort = port;
+				connected = true;
+				sinceHeard.restart();
+
+				sentStates.clear();
+				hasAck = false;
+				lastInputTick = 0;
+				heldActions = 0;
+				pendingActions = 0;
+				world.addAircraft(ClientIdentifier);
+				fromPeer = true;
+			}
+			// Answered every time, a welcome can be lost too
+			if (fromPeer)
+				sendToPeer({ static_cast<char>(Welcome) });
+			break;
+
+		case Input:
+			if (fromPeer)
+			{
+				sinceHeard.restart();
+				handleInput(data);
+			}
+			break;
+
+		case Disconnect:
+			if (fromPeer)
+			{
+				world.removeAircraft(ClientIdentifier);
+				connected = false;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+void CoopSession::receiveAsClient(World& world)
+{
+	std::vector<char> data;
+	sf::IpAddress address;
+	unsigned short port = 0;
+
+	while (link.receive(data, address, port))
+	{
+		if (data.empty() || address != peerAddress || port != peerPort)
+			continue;
+
+		sinceHeard.restart();
+		switch (static_cast<std::uint8_t>(data[0]))
+		{
+		case Welcome:
+			connected = true;
+			break;
+
+		case State:
+			// The welcome may have been lost, the state says as much
+			connected = true;
+			handleState(data, world);
+			break;
+
+		case Disconnect:
+			ended = true;
+			if (data.size() > 1)
+				missionStatus = static_cast<Player::MissionStatus>(data[1]);
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+void CoopSession::handleInput(const std::vector<char>& data)
+{
+	if (data.size() < InputPacketSize)
+		return;
+
+	std::uint32_t inputTick = readUint32(data, 1);
+	std::uint32_t ack = readUint32(data, 5);
+
+	if (ack != NoSequence && (!hasAck || ack > ackedSequence))
+	{
+		ackedSequence = ack;
+		hasAck = true;
+	}
+
+	// Late or duplicated
+	if (inputTick <= lastInputTick)
+		return;
+
+	const Replay::ActionMask realTime = Player::getRealTimeMask();
+	for (std::uint32_t i = 0; i < recentActions.size() && i < inputTick; ++i)
+	{
+		if (inputTick - i > lastInputTick)
+			pendingActions |= static_cast<Replay::ActionMask>(data[9 + i]) & ~realTime;
+	}
+	heldActions = static_cast<Replay::ActionMask>(data[9]) & realTime;
+	lastInputTick = inputTick;
+}
+
+void CoopSession::handleState(const std::vector<char>& data, World& world)
+{
+	if (data.size() < StateHeaderSize)
+		return;
+
+	std::uint32_t sequence = readUint32(data, 1);
+	std::uint32_t baselineSequence = readUint32(data, 5);
+
+	// A newer state is already applied
+	if (hasState && sequence <= receivedSequence)
+		return;
+
+	const NetworkState* baseline = nullptr;
+	if (baselineSequence != NoSequence)
+	{
+		auto found = receivedStates.find(baselineSequence);
+		if (found == receivedStates.end())
+			return;
+		baseline = &found->second;
+	}
+
+	NetworkState state;
+	if (!decodeState(data.data() + StateHeaderSize, data.size() - StateHeaderSize, baseline, state))
+		return;
+
+	world.applyNetworkState(state, ClientIdentifier);
+
+	receivedStates[sequence] = std::move(state);
+	while (receivedStates.size() > HistorySize)
+		receivedStates.erase(receivedStates.begin());
+	receivedSequence = sequence;
+	hasState = true;
+}
+
+void CoopSession::sendState(World& world)
+{
+	world.captureNetworkState(currentState, tick);
+
+	// Against the newest state the client has, when it is still kept
+	const NetworkState* baseline = nullptr;
+	std::uint32_t baselineSequence = NoSequence;
+	if (hasAck)
+	{
+		auto found = sentStates.find(ackedSequence);
+		if (found != sentStates.end())
+		{
+			baseline = &found->second;
+			baselineSequence = ackedSequence;
+		}
+	}
+
+	NetworkState sent;
+	encodeState(currentState, baseline, payload, sent);
+	stateSequence += 1;
+
+	packet.clear();
+	packet.push_back(static_cast<char>(State));
+	writeUint32(packet, stateSequence);
+	writeUint32(packet, baselineSequence);
+	packet.insert(packet.end(), payload.begin(), payload.end());
+	sendToPeer(packet);
+
+	sentStates[stateSequence] = std::move(sent);
+	while (sentStates.size() > HistorySize)
+		sentStates.erase(sentStates.begin());
+
+	profiler.setValue("Net state bytes", static_cast<float>(packet.size()));
+}
+
+void CoopSession::sendToPeer(const std::vector<char>& data)
+{
+	link.send(data, peerAddress, peerPort);
+}
+
+void CoopSession::updateStatistics()
+{
+	if (statisticsClock.getElapsedTime() < sf::seconds(1.f))
+		return;
+
+	std::size_t bytes = link.getBytesSent();
+	float seconds = statisticsClock.restart().asSeconds();
+	profiler.setValue("Net kbps", (bytes - statisticsBytes) * 8.f / 1000.f / seconds);
+	statisticsBytes = bytes;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "NetworkLink.h"
+#include "NetworkSettings.h"
+#include "NetworkState.h"
+#include "Player.h"
+#include "Replay.h"
+
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+class World;
+class Profiler;
+
+// Two player co-op. The host runs the World and sends quantized state, delta
+// encoded against the newest state the client acknowledged; the client only
+// sends its action bits and draws what it receives.
+class CoopSession : private sf::NonCopyable
+{
+public:
+	static const int				HostIdentifier = 0;
+	static const int				ClientIdentifier = 1;
+
+public:
+									CoopSession(const NetworkSettings& settings, Profiler& profiler);
+									~CoopSession();
+
+	bool							isHost() const;
+	// Host: a client has joined. Client: the host answered
+	bool							isConnected() const;
+	// Client: the host ended the mission, left or went silent
+	bool							hasEnded() const;
+	Player::MissionStatus			getMissionStatus() const;
+
+	// Host, after World::update: takes in the client's actions, adds or removes
+	// its aircraft and sends state every few ticks
+	void							updateHost(World& world, Player& remotePlayer);
+	// Client, once per tick: sends this tick's actions, applies the newest state
+	void							updateClient(World& world, Replay::ActionMask actions);
+
+	// Tells the peer, at most once
+	void							disconnect(Player::MissionStatus status);
+
+private:
+	void							receiveAsHost(World& world);
+	void							receiveAsClient(World& world);
+	void							handleInput(const std::vector<char>& data);
+	void							handleState(const std::vector<char>& data, World& world);
+	void							sendState(World& world);
+	void							sendToPeer(const std::vector<char>& data);
+	void							updateStatistics();
+
+private:
+	NetworkSettings					settings;
+	Profiler&						profiler;
+	NetworkLink						link;
+
+	sf::IpAddress					peerAddress;
+	unsigned short					peerPort;
+	bool							connected;
+	bool							ended;
+	bool							disconnected;
+	Player::MissionStatus			missionStatus;
+	sf::Clock						sinceHeard;
+	sf::Clock						sinceHello;
+
+	std::uint32_t					tick;
+	std::vector<char>				packet;
+
+	// Host side
+	std::uint32_t					stateSequence;
+	std::map<std::uint32_t, NetworkState>	sentStates;
+	std::uint32_t					ackedSequence;
+	bool							hasAck;
+	NetworkState					currentState;
+	std::vector<char>				payload;
+	std::uint32_t					lastInputTick;
+	Replay::ActionMask				heldActions;
+	Replay::ActionMask				pendingActions;
+
+	// Client side, the newest action masks are resent with every input packet
+	std::array<Replay::ActionMask, 4>	recentActions;
+	std::map<std::uint32_t, NetworkState>	receivedStates;
+	std::uint32_t					receivedSequence;
+	bool							hasState;
+
+	sf::Clock						statisticsClock;
+	std::size_t						statisticsBytes;
+};
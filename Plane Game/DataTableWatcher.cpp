@@ -0,0 +1,62 @@
+#include "DataTableWatcher.h"
+#include "DataTables.h"
+#include "Utility.h"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+	const sf::Time PollInterval = sf::seconds(0.5f);
+}
+
+DataTableWatcher::DataTableWatcher(const std::string& source, const std::string& binary)
+	: source(source)
+	, binary(binary)
+	, sourceTime(getModificationTime(source))
+	, pollCountdown(PollInterval)
+{
+	// Shipped builds may carry only the binary. One from an older version of
+	// the format is out of date too, however new the file is.
+	if (sourceTime != 0 && (getModificationTime(binary) < sourceTime || !isEntityTableBinaryCurrent(binary)))
+		compileEntityTables(source, binary);
+
+	loadEntityTables(binary, entityTables());
+}
+
+bool DataTableWatcher::update(sf::Time dt)
+{
+	pollCountdown -= dt;
+	if (pollCountdown > sf::Time::Zero)
+		return false;
+	pollCountdown = PollInterval;
+
+	std::time_t time = getModificationTime(source);
+	if (time == 0 || time == sourceTime)
+		return false;
+
+	sourceTime = time;
+	if (!reload())
+		return false;
+
+	std::cout << "Reloaded " << source << std::endl;
+	return true;
+}
+
+bool DataTableWatcher::reload()
+{
+	// A bad edit keeps the current tables, the designer fixes it and saves again
+	try
+	{
+		EntityTables tables;
+		compileEntityTables(source, binary);
+		loadEntityTables(binary, tables);
+		entityTables() = tables;
+		return true;
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Table reload failed: " << e.what() << std::endl;
+		return false;
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <ctime>
+#include <string>
+
+// Keeps entityTables() in sync with the designer edited text source.
+// The binary is rebuilt whenever it is older than the source, and the
+// source is polled while the game runs so saved edits apply in place.
+class DataTableWatcher : private sf::NonCopyable
+{
+public:
+							DataTableWatcher(const std::string& source, const std::string& binary);
+
+	// True when the tables were reloaded
+	bool					update(sf::Time dt);
+
+private:
+	bool					reload();
+
+private:
+	std::string				source;
+	std::string				binary;
+	std::time_t				sourceTime;
+	sf::Time				pollCountdown;
+};
@@ -1,66 +1,386 @@
 #include "DataTables.h"
+#include "Utility.h"
 
-std::map<Aircraft::Type, AircraftData> initializeAircraftData()
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace
 {
-	std::map<Aircraft::Type, AircraftData> data;
-
-	data[Aircraft::Type::Eagle].hitpoints = 100;
-	data[Aircraft::Type::Eagle].speed = 300.f;
-	data[Aircraft::Type::Eagle].fireInterval = sf::seconds(1);
-	data[Aircraft::Type::Eagle].texture = TextureID::Entities;
-	data[Aircraft::Type::Eagle].textureRect = sf::IntRect(0, 0, 48, 64);
-
-
-	data[Aircraft::Type::Raptor].hitpoints = 20;
-	data[Aircraft::Type::Raptor].speed = 80.f;
-	data[Aircraft::Type::Raptor].fireInterval = sf::seconds(1);
-	data[Aircraft::Type::Raptor].texture = TextureID::Entities;
-	data[Aircraft::Type::Raptor].textureRect = sf::IntRect(144, 0, 84, 64);
-
-	data[Aircraft::Type::Raptor].directions.push_back(Direction(+45.f, 80.f));
-	data[Aircraft::Type::Raptor].directions.push_back(Direction(-45.f, 160.f));
-	data[Aircraft::Type::Raptor].directions.push_back(Direction(+45.f, 80.f));
-
-	data[Aircraft::Type::Avenger].hitpoints = 40;
-	data[Aircraft::Type::Avenger].speed = 160.f;
-	data[Aircraft::Type::Avenger].fireInterval = sf::seconds(2);
-	data[Aircraft::Type::Avenger].texture = TextureID::Entities;
-	data[Aircraft::Type::Avenger].textureRect = sf::IntRect(228, 0, 60, 59);
-
-	data[Aircraft::Type::Avenger].directions.push_back(Direction(+45.f, 50.f));
-	data[Aircraft::Type::Avenger].directions.push_back(Direction(0.f, 50.f));
-	data[Aircraft::Type::Avenger].directions.push_back(Direction(-45.f, 100.f));
-	data[Aircraft::Type::Avenger].directions.push_back(Direction(0.f, 50.f));
-	data[Aircraft::Type::Avenger].directions.push_back(Direction(+45.f, 50.f));
-	return data;
+	// Binary layout of Entities.bin. Plain records so loading is a copy,
+	// never a parse: header, aircraft, projectiles, all directions, then all
+	// path points. Paths are sampled into their lookup tables after loading.
+	const std::uint32_t Magic = 0x54444750; // "PGDT"
+	const std::uint32_t Version = 2;
+
+	struct FileHeader
+	{
+		std::uint32_t	magic;
+		std::uint32_t	version;
+		std::uint32_t	aircraftCount;
+		std::uint32_t	projectileCount;
+		std::uint32_t	directionCount;
+		std::uint32_t	pathPointCount;
+	};
+
+	struct AircraftRecord
+	{
+		std::int32_t	hitpoints;
+		float			speed;
+		float			fireInterval;
+		std::int32_t	texture;
+		std::int32_t	textureRect[4];
+		std::uint32_t	firstDirection;
+		std::uint32_t	directionCount;
+		std::uint32_t	firstPathPoint;
+		std::uint32_t	pathPointCount;
+	};
+
+	struct ProjectileRecord
+	{
+		std::int32_t	damage;
+		float			speed;
+		std::int32_t	texture;
+		std::int32_t	textureRect[4];
+	};
+
+	struct DirectionRecord
+	{
+		float			angle;
+		float			distance;
+	};
+
+	struct PathPointRecord
+	{
+		float			x;
+		float			y;
+	};
+
+	const char* AircraftNames[] = { "Eagle", "Raptor", "Avenger", "Viper" };
+	const char* ProjectileNames[] = { "AlliedBullet", "EnemyBullet", "Missile" };
+	const char* TextureNames[] = { "Eagle", "Raptor", "Avenger", "Bullet", "Missile", "Desert", "HealthRefill",
+		"MissileRefill", "FireSpread", "FireRate", "TitleScreen", "Entities", "Jungle", "Buttons", "Explosion",
+		"Particle", "FinishLine", "Face" };
+
+	static_assert(sizeof(AircraftNames) / sizeof(*AircraftNames) == AircraftTable::size(), "Aircraft names out of date");
+	static_assert(sizeof(ProjectileNames) / sizeof(*ProjectileNames) == ProjectileTable::size(), "Projectile names out of date");
+	static_assert(sizeof(TextureNames) / sizeof(*TextureNames) == static_cast<std::size_t>(TextureID::TextureCount), "Texture names out of date");
+
+	template <typename Enum, std::size_t N>
+	Enum parseName(const char* (&names)[N], const std::string& name, const std::string& where)
+	{
+		for (std::size_t i = 0; i < N; ++i)
+		{
+			if (name == names[i])
+				return static_cast<Enum>(i);
+		}
+		throw std::runtime_error(where + ": unknown name \"" + name + "\"");
+	}
+
+	sf::IntRect readRect(std::istream& in)
+	{
+		sf::IntRect rect;
+		in >> rect.left >> rect.top >> rect.width >> rect.height;
+		return rect;
+	}
+
+	void writeRect(std::int32_t (&out)[4], const sf::IntRect& rect)
+	{
+		out[0] = rect.left;
+		out[1] = rect.top;
+		out[2] = rect.width;
+		out[3] = rect.height;
+	}
+
+	template <typename T>
+	void writeRecord(std::ostream& out, const T& record)
+	{
+		out.write(reinterpret_cast<const char*>(&record), sizeof(T));
+	}
+
+	template <typename T>
+	const char* readRecord(const char* in, T& record)
+	{
+		std::memcpy(&record, in, sizeof(T));
+		return in + sizeof(T);
+	}
 }
 
-std::map<Projectile::Type, ProjectileData> initializeProjectileData()
+Aircraft::Type parseAircraftType(const std::string& name, const std::string& where)
 {
-	std::map<Projectile::Type, ProjectileData> data;
+	return parseName<Aircraft::Type>(AircraftNames, name, where);
+}
 
-	data[Projectile::Type::AlliedBullet].damage = 10;
-	data[Projectile::Type::AlliedBullet].speed = 300.f;
-	data[Projectile::Type::AlliedBullet].texture = TextureID::Entities;
-	data[Projectile::Type::AlliedBullet].textureRect = sf::IntRect(175, 64, 3, 14);
+TextureID parseTextureID(const std::string& name, const std::string& where)
+{
+	return parseName<TextureID>(TextureNames, name, where);
+}
 
-	data[Projectile::Type::EnemyBullet].damage = 10;
-	data[Projectile::Type::EnemyBullet].speed = 300.f;
-	data[Projectile::Type::EnemyBullet].texture = TextureID::Entities;
-	data[Projectile::Type::EnemyBullet].textureRect = sf::IntRect(175, 64, 3, 14);
+Direction::Direction(float angle, float distance)
+	: angle(angle)
+	, distance(distance)
+	, heading(std::cos(toRadian(angle + 90.f)), std::sin(toRadian(angle + 90.f)))
+{
+}
 
-	data[Projectile::Type::Missile].damage = 200;
-	data[Projectile::Type::Missile].speed = 150.f;
-	data[Projectile::Type::Missile].texture = TextureID::Entities;
-	data[Projectile::Type::Missile].textureRect = sf::IntRect(160, 64, 15, 32);
+EntityTables& entityTables()
+{
+	static EntityTables tables;
+	return tables;
+}
 
-	return data;
+void compileEntityTables(const std::string& source, const std::string& binary)
+{
+	std::ifstream in(source);
+	if (!in)
+		throw std::runtime_error("compileEntityTables - Failed to open " + source);
+
+	EntityTables tables;
+	std::array<bool, AircraftTable::size()> hasAircraft = {};
+	std::array<bool, ProjectileTable::size()> hasProjectile = {};
+	std::array<std::vector<sf::Vector2f>, AircraftTable::size()> pathPoints;
+
+	std::string line;
+	for (int lineNumber = 1; std::getline(in, line); ++lineNumber)
+	{
+		std::istringstream fields(line);
+		std::string kind, name;
+		if (!(fields >> kind) || kind[0] == '#')
+			continue;
+
+		const std::string where = source + ":" + std::to_string(lineNumber);
+		fields >> name;
+
+		if (kind == "aircraft")
+		{
+			Aircraft::Type type = parseAircraftType(name, where);
+			AircraftData& data = tables.aircraft[type];
+			float fireInterval;
+			std::string texture;
+			if (!(fields >> data.hitpoints >> data.speed >> fireInterval >> texture))
+				throw std::runtime_error(where + ": missing or malformed value");
+			data.fireInterval = sf::seconds(fireInterval);
+			data.texture = parseTextureID(texture, where);
+			data.textureRect = readRect(fields);
+			hasAircraft[static_cast<std::size_t>(type)] = true;
+		}
+		else if (kind == "direction")
+		{
+			Aircraft::Type type = parseAircraftType(name, where);
+			float angle, distance;
+			fields >> angle >> distance;
+			tables.aircraft[type].directions.push_back(Direction(angle, distance));
+		}
+		else if (kind == "path")
+		{
+			Aircraft::Type type = parseAircraftType(name, where);
+			sf::Vector2f point;
+			fields >> point.x >> point.y;
+			pathPoints[static_cast<std::size_t>(type)].push_back(point);
+		}
+		else if (kind == "projectile")
+		{
+			Projectile::Type type = parseName<Projectile::Type>(ProjectileNames, name, where);
+			ProjectileData& data = tables.projectiles[type];
+			std::string texture;
+			if (!(fields >> data.damage >> data.speed >> texture))
+				throw std::runtime_error(where + ": missing or malformed value");
+			data.texture = parseTextureID(texture, where);
+			data.textureRect = readRect(fields);
+			hasProjectile[static_cast<std::size_t>(type)] = true;
+		}
+		else
+		{
+			throw std::runtime_error(where + ": unknown entry \"" + kind + "\"");
+		}
+
+		if (fields.fail())
+			throw std::runtime_error(where + ": missing or malformed value");
+	}
+
+	for (std::size_t i = 0; i < AircraftTable::size(); ++i)
+	{
+		if (!hasAircraft[i])
+			throw std::runtime_error(source + ": no entry for aircraft " + AircraftNames[i]);
+		if (!pathPoints[i].empty() && !tables.aircraft[static_cast<Aircraft::Type>(i)].directions.empty())
+			throw std::runtime_error(source + ": aircraft " + AircraftNames[i] + " has both directions and a path");
+		if (pathPoints[i].size() == 1)
+			throw std::runtime_error(source + ": path of aircraft " + AircraftNames[i] + " needs at least two points");
+	}
+	for (std::size_t i = 0; i < ProjectileTable::size(); ++i)
+	{
+		if (!hasProjectile[i])
+			throw std::runtime_error(source + ": no entry for projectile " + ProjectileNames[i]);
+	}
+
+	FileHeader header;
+	header.magic = Magic;
+	header.version = Version;
+	header.aircraftCount = static_cast<std::uint32_t>(AircraftTable::size());
+	header.projectileCount = static_cast<std::uint32_t>(ProjectileTable::size());
+	header.directionCount = 0;
+	header.pathPointCount = 0;
+	for (std::size_t i = 0; i < AircraftTable::size(); ++i)
+	{
+		header.directionCount += static_cast<std::uint32_t>(tables.aircraft[static_cast<Aircraft::Type>(i)].directions.size());
+		header.pathPointCount += static_cast<std::uint32_t>(pathPoints[i].size());
+	}
+
+	std::ofstream out(binary, std::ios::binary | std::ios::trunc);
+	if (!out)
+		throw std::runtime_error("compileEntityTables - Failed to write " + binary);
+
+	writeRecord(out, header);
+
+	std::uint32_t firstDirection = 0;
+	std::uint32_t firstPathPoint = 0;
+	for (std::size_t i = 0; i < AircraftTable::size(); ++i)
+	{
+		const AircraftData& data = tables.aircraft[static_cast<Aircraft::Type>(i)];
+		AircraftRecord record;
+		record.hitpoints = data.hitpoints;
+		record.speed = data.speed;
+		record.fireInterval = data.fireInterval.asSeconds();
+		record.texture = static_cast<std::int32_t>(data.texture);
+		writeRect(record.textureRect, data.textureRect);
+		record.firstDirection = firstDirection;
+		record.directionCount = static_cast<std::uint32_t>(data.directions.size());
+		record.firstPathPoint = firstPathPoint;
+		record.pathPointCount = static_cast<std::uint32_t>(pathPoints[i].size());
+		writeRecord(out, record);
+		firstDirection += record.directionCount;
+		firstPathPoint += record.pathPointCount;
+	}
+
+	for (std::size_t i = 0; i < ProjectileTable::size(); ++i)
+	{
+		const ProjectileData& data = tables.projectiles[static_cast<Projectile::Type>(i)];
+		ProjectileRecord record;
+		record.damage = data.damage;
+		record.speed = data.speed;
+		record.texture = static_cast<std::int32_t>(data.texture);
+		writeRect(record.textureRect, data.textureRect);
+		writeRecord(out, record);
+	}
+
+	for (std::size_t i = 0; i < AircraftTable::size(); ++i)
+	{
+		for (const Direction& direction : tables.aircraft[static_cast<Aircraft::Type>(i)].directions)
+		{
+			DirectionRecord record;
+			record.angle = direction.angle;
+			record.distance = direction.distance;
+			writeRecord(out, record);
+		}
+	}
+
+	for (const std::vector<sf::Vector2f>& points : pathPoints)
+	{
+		for (sf::Vector2f point : points)
+		{
+			PathPointRecord record;
+			record.x = point.x;
+			record.y = point.y;
+			writeRecord(out, record);
+		}
+	}
+}
+
+void loadEntityTables(const std::string& binary, EntityTables& tables)
+{
+	// One read of the whole file, then fixed size copies out of the buffer
+	std::ifstream in(binary, std::ios::binary);
+	if (!in)
+		throw std::runtime_error("loadEntityTables - Failed to open " + binary);
+	std::vector<char> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	FileHeader header;
+	if (buffer.size() < sizeof(header))
+		throw std::runtime_error("loadEntityTables - Truncated file " + binary);
+	const char* cursor = readRecord(buffer.data(), header);
+
+	const std::size_t expectedSize = sizeof(FileHeader)
+		+ header.aircraftCount * sizeof(AircraftRecord)
+		+ header.projectileCount * sizeof(ProjectileRecord)
+		+ header.directionCount * sizeof(DirectionRecord)
+		+ header.pathPointCount * sizeof(PathPointRecord);
+	if (header.magic != Magic || header.version != Version
+		|| header.aircraftCount != AircraftTable::size() || header.projectileCount != ProjectileTable::size()
+		|| buffer.size() != expectedSize)
+		throw std::runtime_error("loadEntityTables - Incompatible file " + binary);
+
+	std::vector<AircraftRecord> aircraft(header.aircraftCount);
+	for (AircraftRecord& record : aircraft)
+		cursor = readRecord(cursor, record);
+
+	for (std::size_t i = 0; i < header.projectileCount; ++i)
+	{
+		ProjectileRecord record;
+		cursor = readRecord(cursor, record);
+
+		ProjectileData& data = tables.projectiles[static_cast<Projectile::Type>(i)];
+		data.damage = record.damage;
+		data.speed = record.speed;
+		data.texture = static_cast<TextureID>(record.texture);
+		data.textureRect = sf::IntRect(record.textureRect[0], record.textureRect[1], record.textureRect[2], record.textureRect[3]);
+	}
+
+	const char* directions = cursor;
+	const char* pathPoints = directions + header.directionCount * sizeof(DirectionRecord);
+	for (std::size_t i = 0; i < header.aircraftCount; ++i)
+	{
+		const AircraftRecord& record = aircraft[i];
+		if (record.firstDirection + record.directionCount > header.directionCount
+			|| record.firstPathPoint + record.pathPointCount > header.pathPointCount)
+			throw std::runtime_error("loadEntityTables - Incompatible file " + binary);
+
+		AircraftData& data = tables.aircraft[static_cast<Aircraft::Type>(i)];
+		data.hitpoints = record.hitpoints;
+		data.speed = record.speed;
+		data.fireInterval = sf::seconds(record.fireInterval);
+		data.texture = static_cast<TextureID>(record.texture);
+		data.textureRect = sf::IntRect(record.textureRect[0], record.textureRect[1], record.textureRect[2], record.textureRect[3]);
+
+		data.directions.clear();
+		const char* direction = directions + record.firstDirection * sizeof(DirectionRecord);
+		for (std::size_t d = 0; d < record.directionCount; ++d)
+		{
+			DirectionRecord step;
+			direction = readRecord(direction, step);
+			data.directions.push_back(Direction(step.angle, step.distance));
+		}
+
+		std::vector<sf::Vector2f> points;
+		const char* pathPoint = pathPoints + record.firstPathPoint * sizeof(PathPointRecord);
+		for (std::size_t p = 0; p < record.pathPointCount; ++p)
+		{
+			PathPointRecord point;
+			pathPoint = readRecord(pathPoint, point);
+			points.push_back(sf::Vector2f(point.x, point.y));
+		}
+		data.path = FlightPath(points);
+	}
+}
+
+bool isEntityTableBinaryCurrent(const std::string& binary)
+{
+	std::ifstream in(binary, std::ios::binary);
+	FileHeader header;
+	if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+
+	return header.magic == Magic && header.version == Version
+		&& header.aircraftCount == AircraftTable::size() && header.projectileCount == ProjectileTable::size();
 }
 
-std::map<Pickup::Type, PickupData> initializePickupData() 
+PickupTable initializePickupData() 
 {
 
-	std::map<Pickup::Type, PickupData> data;
+	PickupTable data;
 	data[Pickup::Type::HealthRefill].texture = TextureID::Entities;
 	data[Pickup::Type::HealthRefill].textureRect = sf::IntRect(0, 64, 40, 40);
 	data[Pickup::Type::HealthRefill].action = [](Aircraft& a) { a.repair(25); };
@@ -80,15 +400,19 @@ std::map<Pickup::Type, PickupData> initializePickupData()
 	return data;
 }
 
-std::map<Particle::Type, ParticleData>	initializeParticleData()
+ParticleTable initializeParticleData()
 {
-	std::map<Particle::Type, ParticleData> data;
+	ParticleTable data;
 
 	data[Particle::Type::Propellant].color = sf::Color(255, 255, 50);
 	data[Particle::Type::Propellant].lifetime = sf::seconds(0.6f);
+	data[Particle::Type::Propellant].capacity = 2048;
+	data[Particle::Type::Propellant].emissionRate = 30.f;
 
 	data[Particle::Type::Smoke].color = sf::Color(50, 50, 50);
 	data[Particle::Type::Smoke].lifetime = sf::seconds(4.f);
+	data[Particle::Type::Smoke].capacity = 8192;
+	data[Particle::Type::Smoke].emissionRate = 30.f;
 
 	return data;
 }
\ No newline at end of file
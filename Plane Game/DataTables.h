@@ -3,21 +3,23 @@
 #include "ResourceIdentifier.h"
 #include <SFML/System/Time.hpp>
 #include <SFML/Graphics/Color.hpp>
-#include <map>
+#include <SFML/System/Vector2.hpp>
+#include "EnumArray.h"
+#include "FlightPath.h"
 #include <vector>
 #include <functional>
+#include <string>
 #include "Aircraft.h"
 #include "Projectile.h"
 #include "Pickup.h"
 #include "Particle.h"
 
 struct Direction {
-	Direction(float angle, float distance)
-	: angle(angle)
-	, distance(distance)
-	{}
+	Direction(float angle, float distance);
 	float angle;
 	float distance;
+	// Unit velocity of the step, worked out once from the angle
+	sf::Vector2f heading;
 };
 
 struct AircraftData
@@ -28,6 +30,8 @@ struct AircraftData
 	sf::IntRect					textureRect;
 	sf::Time					fireInterval;
 	std::vector<Direction>		directions;
+	// Followed instead of the directions when not empty
+	FlightPath					path;
 };
 struct ProjectileData
 {
@@ -46,10 +50,37 @@ struct ParticleData
 {
 	sf::Color						color;
 	sf::Time						lifetime;
+	std::size_t						capacity;
+	float							emissionRate;
 };
 
+// One entry per type, indexed directly by the type enum
+using AircraftTable = EnumArray<Aircraft::Type, AircraftData, enumCount(Aircraft::Type::TypeCount)>;
+using ProjectileTable = EnumArray<Projectile::Type, ProjectileData, enumCount(Projectile::Type::Count)>;
+using PickupTable = EnumArray<Pickup::Type, PickupData, enumCount(Pickup::Type::TypeCount)>;
+using ParticleTable = EnumArray<Particle::Type, ParticleData, enumCount(Particle::Type::particleCount)>;
+
+// Tables designers tune from Media/Data/Entities.txt
+struct EntityTables
+{
+	AircraftTable					aircraft;
+	ProjectileTable					projectiles;
+};
+
+// Shared by every entity, filled by loadEntityTables and reloaded in place
+EntityTables&								entityTables();
+
+// Parses the text source and writes the binary form, throws on errors
+void										compileEntityTables(const std::string& source, const std::string& binary);
+// Copies the binary form straight into the tables, throws on a bad file
+void										loadEntityTables(const std::string& binary, EntityTables& tables);
+// False for a missing binary or one written for another format or table size
+bool										isEntityTableBinaryCurrent(const std::string& binary);
+
+// Names used in the data files, throw with the given location on an unknown name
+Aircraft::Type								parseAircraftType(const std::string& name, const std::string& where);
+TextureID									parseTextureID(const std::string& name, const std::string& where);
+
 //functions to fill data tables
-std::map <Aircraft::Type, AircraftData>		initializeAircraftData();
-std::map<Projectile::Type, ProjectileData>	initializeProjectileData();
-std::map<Pickup::Type, PickupData>			initializePickupData();
-std::map<Particle::Type, ParticleData>		initializeParticleData();
\ No newline at end of file
+PickupTable									initializePickupData();
+ParticleTable								initializeParticleData();
\ No newline at end of file
@@ -1,8 +1,7 @@
 #include "EmitterNode.h"
 
 #include "ParticleNode.h"
-#include "Command.h"
-#include "CommandQueue.h"
+#include "SceneRegistry.h"
 
 EmitterNode::EmitterNode(Particle::Type type)
 	: SceneNode()
@@ -13,30 +12,20 @@ EmitterNode::EmitterNode(Particle::Type type)
 
 }
 
+void EmitterNode::onAttach(SceneRegistry& registry)
+{
+	particleSystem = registry.getParticleSystem(type);
+}
+
 void EmitterNode::updateCurrent(sf::Time dt, CommandQueue& commands)
 {
 	if (particleSystem)
-	{
 		emitParticles(dt);
-	}
-	else
-	{
-		// Find particle node with the same type as emitter node
-		auto finder = [this](ParticleNode& container, sf::Time)
-		{
-			if (container.getParticleType() == type)
-				particleSystem = &container;
-		};
-		Command command;
-		command.category = Category::ParticleSystem;
-		command.action = derivedAction<ParticleNode>(finder);
-		commands.push(command);
-	}
 }
 
 void EmitterNode::emitParticles(sf::Time dt)
 {
-	const float emissionRate = 30.f;
+	const float emissionRate = particleSystem->getEmissionRate();
 	const sf::Time interval = sf::seconds(1.f) / emissionRate;
 
 	accumulatedTime += dt;
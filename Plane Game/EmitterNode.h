@@ -10,6 +10,7 @@ public:
 					EmitterNode(Particle::Type type);
 
 private:
+	virtual void	onAttach(SceneRegistry& registry) override;
 	virtual void	updateCurrent(sf::Time dt, CommandQueue& commands) override;
 	void			emitParticles(sf::Time dt);
 
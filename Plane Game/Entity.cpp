@@ -1,8 +1,14 @@
 #include "Entity.h"
 #include <cassert>
 
+namespace
+{
+	std::uint32_t NextNetworkId = 1;
+}
+
 Entity::Entity(int hitPoints)
 	:hitPoints(hitPoints)
+	,networkId(NextNetworkId++)
 {
 }
 
@@ -50,6 +56,16 @@ void Entity::damage(int points)
 	hitPoints -= points;
 }
 
+void Entity::setHitpoints(int points)
+{
+	hitPoints = points;
+}
+
+std::uint32_t Entity::getNetworkId() const
+{
+	return networkId;
+}
+
 void Entity::destroy()
 {
 	hitPoints = 0;
@@ -1,5 +1,6 @@
 #pragma once
 #include "SceneNode.h"
+#include <cstdint>
 
 class Entity : public SceneNode
 {
@@ -15,11 +16,16 @@ public:
 	sf::Vector2f			getVelocity() const;
 
 	int						getHitpoints() const;
+	// Co-op clients take hitpoints straight from the host
+	void					setHitpoints(int points);
 	void					repair(int points);
 	void					damage(int points);
 	void					destroy();
 	virtual bool			isDestroyed() const;
 
+	// Unique for the lifetime of the process, names the entity in co-op state
+	std::uint32_t			getNetworkId() const;
+
 protected:
 	virtual void			updateCurrent(sf::Time dt, CommandQueue& commands) override;
 
@@ -27,5 +33,6 @@ protected:
 private:
 	sf::Vector2f			velocity;
 	int						hitPoints;
+	std::uint32_t			networkId;
 };
 
@@ -0,0 +1,37 @@
+#pragma once
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+// Fixed size array indexed directly by a dense enum. Count is the number of
+// enumerators, usually the trailing "Count" entry of the enum.
+template <typename Enum, typename T, std::size_t Count>
+class EnumArray
+{
+public:
+	T& operator[](Enum key)
+	{
+		assert(static_cast<std::size_t>(key) < Count);
+		return values[static_cast<std::size_t>(key)];
+	}
+
+	const T& operator[](Enum key) const
+	{
+		assert(static_cast<std::size_t>(key) < Count);
+		return values[static_cast<std::size_t>(key)];
+	}
+
+	static constexpr std::size_t size()
+	{
+		return Count;
+	}
+
+private:
+	std::array<T, Count>	values;
+};
+
+template <typename Enum>
+constexpr std::size_t enumCount(Enum count)
+{
+	return static_cast<std::size_t>(count);
+}
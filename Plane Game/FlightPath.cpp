@@ -0,0 +1,111 @@
+#include "FlightPath.h"
+#include "Utility.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Dense enough that the chords are within a fraction of a pixel of the curve
+	const int StepsPerSegment = 64;
+
+	sf::Vector2f catmullRom(sf::Vector2f p0, sf::Vector2f p1, sf::Vector2f p2, sf::Vector2f p3, float t)
+	{
+		float t2 = t * t;
+		float t3 = t2 * t;
+		return 0.5f * ((2.f * p1)
+			+ (p2 - p0) * t
+			+ (2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * t2
+			+ (3.f * p1 - p0 - 3.f * p2 + p3) * t3);
+	}
+}
+
+const float FlightPath::SampleSpacing = 4.f;
+
+FlightPath::FlightPath()
+	: points()
+	, samples()
+	, length(0.f)
+{
+}
+
+FlightPath::FlightPath(const std::vector<sf::Vector2f>& points)
+	: points(points)
+	, samples()
+	, length(0.f)
+{
+	if (points.size() < 2)
+	{
+		samples = points;
+		return;
+	}
+
+	// Walk the curve in small parameter steps, with the end points repeated
+	// so the curve passes through every point
+	std::vector<sf::Vector2f> curve;
+	std::vector<float> distances;
+	curve.push_back(points.front());
+	distances.push_back(0.f);
+
+	for (std::size_t i = 0; i + 1 < points.size(); ++i)
+	{
+		sf::Vector2f p0 = points[i == 0 ? 0 : i - 1];
+		sf::Vector2f p3 = points[std::min(i + 2, points.size() - 1)];
+		for (int step = 1; step <= StepsPerSegment; ++step)
+		{
+			float t = static_cast<float>(step) / StepsPerSegment;
+			sf::Vector2f point = catmullRom(p0, points[i], points[i + 1], p3, t);
+			distances.push_back(distances.back() + ::length(point - curve.back()));
+			curve.push_back(point);
+		}
+	}
+	length = distances.back();
+
+	// Resample at equal distances, plus the very end, which is usually closer
+	std::size_t segment = 1;
+	for (std::size_t k = 0; k * SampleSpacing < length; ++k)
+	{
+		float distance = k * SampleSpacing;
+		while (distances[segment] < distance)
+			++segment;
+
+		float span = distances[segment] - distances[segment - 1];
+		float blend = span > 0.f ? (distance - distances[segment - 1]) / span : 0.f;
+		samples.push_back(curve[segment - 1] + (curve[segment] - curve[segment - 1]) * blend);
+	}
+	samples.push_back(curve.back());
+}
+
+bool FlightPath::isEmpty() const
+{
+	return samples.empty();
+}
+
+float FlightPath::getLength() const
+{
+	return length;
+}
+
+const std::vector<sf::Vector2f>& FlightPath::getPoints() const
+{
+	return points;
+}
+
+sf::Vector2f FlightPath::getPosition(float distance) const
+{
+	if (samples.size() < 2)
+		return samples.empty() ? sf::Vector2f() : samples.front();
+
+	if (distance <= 0.f)
+		return samples[0] + normalize(samples[1] - samples[0]) * distance;
+
+	std::size_t last = samples.size() - 1;
+	if (distance >= length)
+		return samples[last] + normalize(samples[last] - samples[last - 1]) * (distance - length);
+
+	std::size_t index = std::min(static_cast<std::size_t>(distance / SampleSpacing), last - 1);
+	// The last step is usually shorter than the spacing
+	float end = std::min((index + 1) * SampleSpacing, length);
+	float blend = (distance - index * SampleSpacing) / (end - index * SampleSpacing);
+	return samples[index] + (samples[index + 1] - samples[index]) * blend;
+}
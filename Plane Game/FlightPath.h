@@ -0,0 +1,31 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+
+// Catmull-Rom spline through designer placed points, relative to where the
+// aircraft spawns. At load the curve is resampled at equal arc length steps,
+// so a position at any distance along it is one lookup and one lerp. Every
+// aircraft of a type shares its path; each only keeps how far along it is.
+class FlightPath
+{
+public:
+	// Distance between two samples of the lookup table
+	static const float			SampleSpacing;
+
+public:
+								FlightPath();
+	explicit					FlightPath(const std::vector<sf::Vector2f>& points);
+
+	bool						isEmpty() const;
+	float						getLength() const;
+	const std::vector<sf::Vector2f>&	getPoints() const;
+
+	// Past either end the path continues straight along its end direction
+	sf::Vector2f				getPosition(float distance) const;
+
+private:
+	std::vector<sf::Vector2f>	points;
+	std::vector<sf::Vector2f>	samples;
+	float						length;
+};
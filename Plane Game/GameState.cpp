@@ -1,32 +1,116 @@
 #include "GameState.h"
 #include "MusicPlayer.h"
+#include "Profiler.h"
 #include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/System/Clock.hpp>
+
+namespace
+{
+	// 30 s at 60 ticks per second, a keyframe each second
+	const std::size_t RewindTicks = 30 * 60;
+	const std::size_t RewindKeyframeInterval = 60;
+	const std::size_t RewindByteBudget = 8 * 1024 * 1024;
+}
 GameState::GameState(StateStack& stack, Context context)
 	:State(stack,context)
-	,world(*context.window,*context.fonts, *context.sounds)
+	,world(*context.window,*context.fonts, *context.sounds, *context.workers, *context.loader, *context.profiler)
 	,player(*context.player)
+	,checkpoint()
+	,hasCheckpoint(false)
+	,startFromCheckpoint(false)
+	,rewind(RewindTicks, RewindKeyframeInterval, RewindByteBudget)
+	,tickSnapshot()
+	,rewindEnabled(false)
+	,session()
+	,remotePlayer(CoopSession::ClientIdentifier)
+	,rollback()
 {
 
 	context.music->play(MusicID::MissionTheme);
+	if (context.network->role != NetworkSettings::Role::Offline && context.network->rollback)
+		rollback.reset(new RollbackSession(*context.network, *context.profiler));
+	else if (context.network->role != NetworkSettings::Role::Offline)
+		session.reset(new CoopSession(*context.network, *context.profiler));
+
+	// A client records nothing, the host owns the mission
+	if (!isClient())
+		player.beginMission();
+
+	// Restored once the world has loaded; co-op and replays always start fresh
+	if (context.startSnapshot && !session && !rollback && !player.getReplay().isPlaying())
+	{
+		checkpoint = *context.startSnapshot;
+		hasCheckpoint = true;
+		startFromCheckpoint = true;
+	}
+}
+
+GameState::~GameState()
+{
+	if (session)
+		session->disconnect(player.getMissionStatus());
+	if (!isClient())
+		player.endMission();
 }
 
 void GameState::draw()
 {
-	world.draw();
+	// The loading state covers us until the world is ready
+	if (world.isLoaded())
+		world.draw();
 
 }
 
 bool GameState::update(sf::Time dt)
 {
+	if (!world.isLoaded())
+		return true;
+	if (startFromCheckpoint)
+	{
+		// The recording would not match a mission that starts midway
+		world.restoreSnapshot(checkpoint);
+		player.getReplay().stopRecording();
+		startFromCheckpoint = false;
+	}
+	if (rollback)
+		return updateRollback();
+	if (isClient())
+		return updateClient(dt);
+
+	if (rewindEnabled && !player.getReplay().isPlaying() && sf::Keyboard::isKeyPressed(sf::Keyboard::R))
+	{
+		// The recording no longer matches what the player sees
+		if (rewind.stepBack(tickSnapshot))
+		{
+			world.restoreSnapshot(tickSnapshot);
+			player.getReplay().stopRecording();
+		}
+		return true;
+	}
+
 	world.update(dt);
-	if (!world.hasAlivePlayer()) {
-		player.setMissionStatus(Player::MissionStatus::Failure);
-		requestStackPush(StateID::GameOver);
+
+	if (session)
+	{
+		session->updateHost(world, remotePlayer);
+		// Only this side's actions are recorded, a co-op mission cannot be replayed
+		if (session->isConnected())
+			player.getReplay().stopRecording();
 	}
-	else if (world.hasPlayerReachedEnd()) {
-		player.setMissionStatus(Player::MissionStatus::Success);
-		requestStackPush(StateID::GameOver);
+
+	// Taken before the input of the next tick enters the command queue
+	if (rewindEnabled)
+	{
+		sf::Clock clock;
+		world.saveSnapshot(tickSnapshot);
+		rewind.push(tickSnapshot);
+		getContext().profiler->addSample("Rewind", clock.getElapsedTime());
+		getContext().profiler->setValue("Rewind KB", static_cast<float>(rewind.getByteCount() / 1024));
 	}
+	if (!world.hasAlivePlayer())
+		endMission(Player::MissionStatus::Failure);
+	else if (world.hasPlayerReachedEnd())
+		endMission(Player::MissionStatus::Success);
 	CommandQueue& commands = world.getCommands();
 	player.handleRealTimeInput(commands);
 
@@ -44,9 +128,90 @@ bool GameState::handleEvents(const sf::Event& event)
 	//Q pressed, trigger the menu state
 	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Q)
 		requestStackPush(StateID::Menu);
+	//F2 pressed, cycle bloom quality
+	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F2)
+	{
+		int next = (static_cast<int>(world.getBloomQuality()) + 1) % static_cast<int>(BloomEffect::Quality::QualityCount);
+		world.setBloomQuality(static_cast<BloomEffect::Quality>(next));
+	}
+	//F12 pressed, save a screenshot with bloom applied on the CPU
+	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F12)
+	{
+		sf::Image image;
+		world.capture(image);
+		image.saveToFile("Capture.png");
+	}
+	// A replay keeps feeding its recorded actions, a checkpoint would not match them
+	bool canCheckpoint = world.isLoaded() && !isClient() && !rollback && !player.getReplay().isPlaying();
+	//F5 pressed, checkpoint the mission, also kept on disk for bug reports
+	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F5 && canCheckpoint)
+	{
+		world.saveSnapshot(checkpoint);
+		checkpoint.saveToFile("Checkpoint.snap");
+		hasCheckpoint = true;
+	}
+	//F9 pressed, return to the checkpoint; the recording no longer matches the mission
+	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F9 && hasCheckpoint && canCheckpoint)
+	{
+		world.restoreSnapshot(checkpoint);
+		player.getReplay().stopRecording();
+	}
+	//F6 pressed, start or stop the rewind recording
+	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F6)
+	{
+		rewindEnabled = !rewindEnabled;
+		rewind.clear();
+	}
 	//G pressed, trigger the gex state
 	//if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::G)
 		//requestStackPush(StateID::Gex);
 
 	return false;
 }
+
+bool GameState::isClient() const
+{
+	return (session && !session->isHost()) || (rollback && !rollback->isHost());
+}
+
+bool GameState::updateClient(sf::Time dt)
+{
+	session->updateClient(world, player.collectActions());
+	world.updateRemote(dt);
+
+	if (session->hasEnded())
+	{
+		player.setMissionStatus(session->getMissionStatus());
+		requestStackPush(StateID::GameOver);
+	}
+	return true;
+}
+
+bool GameState::updateRollback()
+{
+	if (!rollback->advance(world, player.collectActions()))
+	{
+		if (rollback->hasEnded())
+			endMission(world.hasPlayerReachedEnd() ? Player::MissionStatus::Success : Player::MissionStatus::Failure);
+		return true;
+	}
+
+	// Only this side's actions are recorded, a co-op mission cannot be replayed
+	player.getReplay().stopRecording();
+
+	// Both peers get here on the same tick, unless a late action changes the outcome
+	if (!world.hasAlivePlayer())
+		endMission(Player::MissionStatus::Failure);
+	else if (world.hasPlayerReachedEnd())
+		endMission(Player::MissionStatus::Success);
+	return true;
+}
+
+void GameState::endMission(Player::MissionStatus status)
+{
+	player.setMissionStatus(status);
+	// The client shows the same result; a rollback peer finds it on its own
+	if (session)
+		session->disconnect(status);
+	requestStackPush(StateID::GameOver);
+}
@@ -3,19 +3,48 @@
 #include "World.h"
 #include "Player.h"
 #include "State.h"
+#include "RewindBuffer.h"
+#include "CoopSession.h"
+#include "RollbackSession.h"
+
+#include <memory>
 
 class GameState : public State
 {
 public:
 							GameState(StateStack& stack, Context context);
+							~GameState();
 
 	virtual void			draw() override;
 	virtual bool			update(sf::Time dt) override;
 	virtual bool			handleEvents(const sf::Event& event) override;
 
+private:
+	bool					isClient() const;
+	bool					updateClient(sf::Time dt);
+	bool					updateRollback();
+	void					endMission(Player::MissionStatus status);
+
 private:
 	World					world;
 	Player&					player;
 
+	// F5 stores, F9 returns to it; --snapshot starts the mission there
+	WorldSnapshot			checkpoint;
+	bool					hasCheckpoint;
+	bool					startFromCheckpoint;
+
+	// Off until F6, so a tick without recording costs one flag test. Holding R
+	// scrubs back through the last seconds recorded, F6 again drops them.
+	RewindBuffer			rewind;
+	WorldSnapshot			tickSnapshot;
+	bool					rewindEnabled;
+
+	// Co-op only, the host flies the client's aircraft with its actions
+	std::unique_ptr<CoopSession>	session;
+	Player					remotePlayer;
+	// Co-op with rollback instead, both peers simulate
+	std::unique_ptr<RollbackSession>	rollback;
+
 };
 
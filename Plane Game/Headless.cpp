@@ -0,0 +1,217 @@
+#include "Headless.h"
+#include "CoopSession.h"
+#include "Player.h"
+#include "RollbackSession.h"
+#include "Random.h"
+
+#include <SFML/Audio/Listener.hpp>
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Sleep.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+	// Same as the window, the view size decides what is on the battlefield
+	const unsigned int ViewWidth = 1280;
+	const unsigned int ViewHeight = 720;
+
+	// 20 s of play, then both sides compare
+	const std::uint32_t RollbackTestTicks = 20 * 60;
+
+	// FNV-1a over the serialized snapshot
+	std::uint64_t checksum(const std::vector<char>& data)
+	{
+		std::uint64_t hash = 14695981039346656037ull;
+		for (char byte : data)
+		{
+			hash ^= static_cast<std::uint8_t>(byte);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// Plays the ticks from the start state as RollbackSession::simulate does,
+	// host first, and returns the checksum of the final state
+	std::uint64_t runReference(const std::vector<char>& startState, const std::vector<Replay::ActionMask>& hostActions,
+		const std::vector<Replay::ActionMask>& clientActions, std::uint32_t ticks)
+	{
+		HeadlessWorld headless;
+		World& world = headless.getWorld();
+		headless.finishLoading();
+
+		WorldSnapshot snapshot;
+		snapshot.readFrom(startState.data(), startState.size());
+		world.restoreSnapshot(snapshot);
+
+		Player host(CoopSession::HostIdentifier);
+		Player client(CoopSession::ClientIdentifier);
+		for (std::uint32_t tick = 0; tick < ticks; ++tick)
+		{
+			host.pushActions(hostActions[tick], world.getCommands());
+			client.pushActions(clientActions[tick], world.getCommands());
+			world.update(HeadlessWorld::TimePerFrame);
+		}
+
+		std::vector<char> data;
+		world.saveSnapshot(snapshot);
+		snapshot.writeTo(data);
+		return checksum(data);
+	}
+}
+
+const sf::Time HeadlessWorld::TimePerFrame = sf::seconds(1.f / 60.f);
+
+HeadlessWorld::HeadlessWorld(sf::RenderWindow* window)
+	: target()
+	, window(window)
+	, workers()
+	, loader(workers)
+	, fonts()
+	, sounds(loader)
+	, profiler()
+	, world()
+{
+	// Never displayed, but shaders and render textures still need a context
+	if (!window && !target.create(ViewWidth, ViewHeight))
+		throw std::runtime_error("HeadlessWorld::HeadlessWorld - Failed to create render target");
+
+	fonts.load(FontID::Main, "Media/Sansation.ttf");
+	sf::Listener::setGlobalVolume(0.f);
+	world.reset(new World(window ? static_cast<sf::RenderTarget&>(*window) : target, fonts, sounds, workers, loader, profiler));
+}
+
+void HeadlessWorld::finishLoading()
+{
+	loader.finishAll();
+}
+
+void HeadlessWorld::display()
+{
+	if (window)
+		window->display();
+	else
+		target.display();
+}
+
+sf::Image HeadlessWorld::copyImage() const
+{
+	return target.getTexture().copyToImage();
+}
+
+World& HeadlessWorld::getWorld()
+{
+	return *world;
+}
+
+Profiler& HeadlessWorld::getProfiler()
+{
+	return profiler;
+}
+
+int runHeadlessReplay(const std::string& filename)
+{
+	Player player;
+	Replay& replay = player.getReplay();
+	replay.loadFromFile(filename);
+	replay.startPlayback();
+
+	HeadlessWorld headless;
+	World& world = headless.getWorld();
+	player.beginMission();
+	headless.finishLoading();
+
+	// Same order as GameState::update
+	sf::Clock clock;
+	std::size_t ticks = 0;
+	while (true)
+	{
+		world.update(HeadlessWorld::TimePerFrame);
+		ticks += 1;
+		if (!world.hasAlivePlayer() || world.hasPlayerReachedEnd())
+			break;
+
+		player.handleRealTimeInput(world.getCommands());
+		if (!replay.isPlaying())
+			break;
+	}
+	sf::Time elapsed = clock.getElapsedTime();
+
+	std::cout << filename << ": " << ticks << " of " << replay.getTickCount() << " ticks, "
+		<< (HeadlessWorld::TimePerFrame * static_cast<sf::Int64>(ticks)).asSeconds() << "s simulated in "
+		<< elapsed.asSeconds() << "s (" << ticks / std::max(elapsed.asSeconds(), 0.001f) << " ticks/s)\n"
+		<< (world.hasAlivePlayer() ? "player alive" : "player dead") << "\n"
+		<< headless.getProfiler().flushReport();
+	return 0;
+}
+
+int runRollbackTest(const NetworkSettings& settings)
+{
+	HeadlessWorld headless;
+	World& world = headless.getWorld();
+	seedRandom(generateSeed());
+	headless.finishLoading();
+
+	RollbackSession session(settings, headless.getProfiler());
+	std::cout << (session.isHost() ? "Waiting for a client" : "Joining") << " on port " << settings.port << std::endl;
+
+	// Each side presses its own pseudo random keys, changing a few times a second
+	RandomStream script(generateSeed(), session.isHost() ? 1 : 2);
+	Replay::ActionMask actions = 0;
+
+	// Paced like the game, so stalls and rollbacks happen as they would in play
+	sf::Clock clock;
+	sf::Time lag = sf::Time::Zero;
+	while (!session.hasEnded())
+	{
+		lag += clock.restart();
+		if (lag < HeadlessWorld::TimePerFrame)
+		{
+			sf::sleep(HeadlessWorld::TimePerFrame - lag);
+			continue;
+		}
+		lag -= HeadlessWorld::TimePerFrame;
+
+		// Keeps going with both players dead, the level still scrolls and spawns
+		if (session.getTick() < RollbackTestTicks)
+		{
+			if (script.nextInt(15) == 0)
+				actions = static_cast<Replay::ActionMask>(script.nextInt(256));
+			session.advance(world, actions);
+		}
+		else
+		{
+			session.synchronize(world);
+			// The peer may still need our last actions
+			if (session.isConfirmed() && session.isPeerSynchronized(session.getTick()))
+				break;
+		}
+	}
+
+	if (session.hasEnded())
+	{
+		std::cout << "The peer left or timed out at tick " << session.getTick() << std::endl;
+		return 1;
+	}
+
+	WorldSnapshot snapshot;
+	std::vector<char> data;
+	world.saveSnapshot(snapshot);
+	snapshot.writeTo(data);
+
+	std::cout << "Tick " << session.getTick() << ", " << snapshot.aircraft.size() << " aircraft, "
+		<< snapshot.projectiles.size() << " projectiles, checksum " << std::hex << checksum(data) << std::dec << "\n"
+		<< headless.getProfiler().flushReport();
+
+	// The same ticks again in a fresh World, straight through with the real actions
+	std::uint64_t reference = runReference(session.getStartState(), session.getHostActions(), session.getClientActions(), session.getTick());
+	std::cout << "Reference without rollback, checksum " << std::hex << reference << std::dec << std::endl;
+	if (reference != checksum(data))
+	{
+		std::cout << "Rollback changed the outcome" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "World.h"
+#include "ThreadPool.h"
+#include "ResourceLoader.h"
+#include "SoundPlayer.h"
+#include "Profiler.h"
+#include "NetworkSettings.h"
+
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/System/NonCopyable.hpp>
+
+#include <memory>
+#include <string>
+
+// A muted World and everything it needs, rendering into a texture that is
+// never displayed, or into a window for runs that should be watched
+class HeadlessWorld : private sf::NonCopyable
+{
+public:
+	static const sf::Time			TimePerFrame;
+
+public:
+	explicit						HeadlessWorld(sf::RenderWindow* window = nullptr);
+
+	// Seed first, the scene draws random streams while it is built
+	void							finishLoading();
+
+	// After World::draw: shows the window or flushes the texture
+	void							display();
+	// What the last draw left in the hidden texture, after display
+	sf::Image						copyImage() const;
+
+	World&							getWorld();
+	Profiler&						getProfiler();
+
+private:
+	sf::RenderTexture				target;
+	sf::RenderWindow*				window;
+	ThreadPool						workers;
+	ResourceLoader					loader;
+	FontHolder_t					fonts;
+	SoundPlayer						sounds;
+	Profiler						profiler;
+	std::unique_ptr<World>			world;
+};
+
+// Plays a replay through World as fast as possible without a window and
+// prints the timings, run with "--replay <file> --headless".
+// Returns the process exit code.
+int runHeadlessReplay(const std::string& filename);
+
+// One side of the rollback determinism test, run once with --host and once
+// with --join in a second process. Both play scripted actions for a fixed
+// number of ticks and print a checksum of the final World, which must match.
+// Returns the process exit code.
+int runRollbackTest(const NetworkSettings& settings);
@@ -0,0 +1,487 @@
+#include "LevelStream.h"
+#include "DataTables.h"
+#include "ThreadPool.h"
+#include "Utility.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+	// Binary layout: header, one index record per chunk, then the events of
+	// each chunk (spawns, segments, triggers) at the offset its record gives
+	const std::uint32_t Magic = 0x564c4750; // "PGLV"
+	const std::uint32_t Version = 4;
+
+	// Chunks read ahead of the lookahead distance
+	const std::size_t PrefetchChunks = 1;
+
+	struct FileHeader
+	{
+		std::uint32_t	magic;
+		std::uint32_t	version;
+		float			stageLength;
+		float			chunkLength;
+		std::uint32_t	chunkCount;
+	};
+
+	struct ChunkRecord
+	{
+		std::uint64_t	offset;
+		std::uint32_t	spawnCount;
+		std::uint32_t	segmentCount;
+		std::uint32_t	triggerCount;
+		std::uint32_t	padding;
+	};
+
+	struct SpawnRecord
+	{
+		std::int32_t	type;
+		float			x;
+		float			distance;
+		float			delay;
+		std::int32_t	formation;
+		std::uint32_t	count;
+		float			spacing;
+		std::int32_t	timed;
+	};
+
+	struct SegmentRecord
+	{
+		std::int32_t	texture;
+		float			distance;
+		float			length;
+		float			blend;
+	};
+
+	struct TriggerRecord
+	{
+		std::int32_t	type;
+		float			distance;
+		float			value;
+	};
+
+	const char* TriggerNames[] = { "ScrollSpeed" };
+	const char* FormationNames[] = { "Single", "Line", "Column", "Vee", "Trail" };
+	static_assert(sizeof(TriggerNames) / sizeof(*TriggerNames) == static_cast<std::size_t>(LevelTrigger::Type::TypeCount), "Trigger names out of date");
+	static_assert(sizeof(FormationNames) / sizeof(*FormationNames) == static_cast<std::size_t>(Formation::FormationCount), "Formation names out of date");
+
+	template <typename Enum, std::size_t N>
+	Enum parseName(const char* (&names)[N], const std::string& name, const std::string& where)
+	{
+		auto found = std::find(std::begin(names), std::end(names), name);
+		if (found == std::end(names))
+			throw std::runtime_error(where + ": unknown name \"" + name + "\"");
+		return static_cast<Enum>(found - std::begin(names));
+	}
+
+	template <typename T>
+	void writeRecord(std::ostream& out, const T& record)
+	{
+		out.write(reinterpret_cast<const char*>(&record), sizeof(T));
+	}
+
+	template <typename T>
+	void readRecord(std::istream& in, T& record, const std::string& filename)
+	{
+		if (!in.read(reinterpret_cast<char*>(&record), sizeof(T)))
+			throw std::runtime_error("LevelStream - Truncated file " + filename);
+	}
+
+	template <typename T>
+	void sortByDistance(std::vector<T>& events)
+	{
+		std::stable_sort(events.begin(), events.end(), [](const T& lhs, const T& rhs)
+		{
+			return lhs.distance < rhs.distance;
+		});
+	}
+
+	// False for a missing binary or one from another version of the format
+	bool isCurrent(const std::string& binary)
+	{
+		std::ifstream in(binary, std::ios::binary);
+		FileHeader header;
+		if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return false;
+		return header.magic == Magic && header.version == Version;
+	}
+
+	std::shared_ptr<LevelChunk> readChunk(const std::string& filename, std::uint64_t offset,
+		std::uint32_t spawnCount, std::uint32_t segmentCount, std::uint32_t triggerCount)
+	{
+		std::ifstream in(filename, std::ios::binary);
+		if (!in.seekg(static_cast<std::streamoff>(offset)))
+			throw std::runtime_error("LevelStream - Failed to read " + filename);
+
+		auto chunk = std::make_shared<LevelChunk>();
+		for (std::uint32_t i = 0; i < spawnCount; ++i)
+		{
+			SpawnRecord record;
+			readRecord(in, record, filename);
+			SpawnEvent spawn;
+			spawn.request.type = static_cast<Aircraft::Type>(record.type);
+			spawn.request.x = record.x;
+			spawn.request.formation = static_cast<Formation>(record.formation);
+			spawn.request.count = record.count;
+			spawn.request.spacing = record.spacing;
+			spawn.distance = record.distance;
+			spawn.delay = record.delay;
+			spawn.timed = record.timed != 0;
+			chunk->spawns.push_back(spawn);
+		}
+		for (std::uint32_t i = 0; i < segmentCount; ++i)
+		{
+			SegmentRecord record;
+			readRecord(in, record, filename);
+			chunk->segments.push_back({ static_cast<TextureID>(record.texture), record.distance, record.length, record.blend });
+		}
+		for (std::uint32_t i = 0; i < triggerCount; ++i)
+		{
+			TriggerRecord record;
+			readRecord(in, record, filename);
+			chunk->triggers.push_back({ static_cast<LevelTrigger::Type>(record.type), record.distance, record.value });
+		}
+		return chunk;
+	}
+}
+
+LevelStream::LevelStream(ThreadPool& workers, const std::string& source, const std::string& binary)
+	: workers(workers)
+	, filename(binary)
+	, stageLength(0.f)
+	, chunkLength(0.f)
+	, chunks()
+	, resident()
+	, spawnCursor()
+	, segmentCursor()
+	, triggerCursor()
+{
+	// An older format version is out of date too, however new the file is
+	std::time_t sourceTime = getModificationTime(source);
+	if (sourceTime != 0 && (getModificationTime(binary) < sourceTime || !isCurrent(binary)))
+		compileLevel(source, binary);
+
+	// Only the header and chunk index stay in memory
+	std::ifstream in(binary, std::ios::binary);
+	if (!in)
+		throw std::runtime_error("LevelStream - Failed to open " + binary);
+
+	FileHeader header;
+	readRecord(in, header, binary);
+	if (header.magic != Magic || header.version != Version || header.chunkCount == 0 || header.chunkLength <= 0.f)
+		throw std::runtime_error("LevelStream - Incompatible file " + binary);
+
+	stageLength = header.stageLength;
+	chunkLength = header.chunkLength;
+	for (std::uint32_t i = 0; i < header.chunkCount; ++i)
+	{
+		ChunkRecord record;
+		readRecord(in, record, binary);
+		chunks.push_back({ record.offset, record.spawnCount, record.segmentCount, record.triggerCount });
+	}
+}
+
+float LevelStream::getStageLength() const
+{
+	return stageLength;
+}
+
+std::size_t LevelStream::getResidentChunkCount() const
+{
+	return resident.size();
+}
+
+void LevelStream::update(float camera, float lookahead)
+{
+	std::size_t first = std::min({ spawnCursor.chunk, segmentCursor.chunk, triggerCursor.chunk });
+	std::size_t last = std::min(chunkAt(lookahead) + PrefetchChunks, chunks.size() - 1);
+
+	for (std::size_t i = first; i <= last; ++i)
+		request(i);
+
+	// A chunk goes once every event in it was handed out and the camera has passed it
+	for (auto itr = resident.begin(); itr != resident.end();)
+	{
+		if (itr->first < first && (itr->first + 1) * chunkLength <= camera)
+		{
+			// Never drop a job that still writes into the chunk
+			if (itr->second.loading.valid())
+				itr->second.loading.wait();
+			itr = resident.erase(itr);
+		}
+		else
+		{
+			++itr;
+		}
+	}
+}
+
+void LevelStream::popSpawns(float distance, std::vector<SpawnEvent>& output)
+{
+	pop(spawnCursor, &LevelChunk::spawns, distance, output);
+}
+
+void LevelStream::popSegments(float distance, std::vector<BackgroundSegment>& output)
+{
+	pop(segmentCursor, &LevelChunk::segments, distance, output);
+}
+
+void LevelStream::popTriggers(float distance, std::vector<LevelTrigger>& output)
+{
+	pop(triggerCursor, &LevelChunk::triggers, distance, output);
+}
+
+void LevelStream::getCursors(std::uint64_t (&cursors)[6]) const
+{
+	const Cursor* lists[] = { &spawnCursor, &segmentCursor, &triggerCursor };
+	for (std::size_t i = 0; i < 3; ++i)
+	{
+		cursors[i * 2] = lists[i]->chunk;
+		cursors[i * 2 + 1] = lists[i]->index;
+	}
+}
+
+void LevelStream::seek(const std::uint64_t (&cursors)[6])
+{
+	Cursor* lists[] = { &spawnCursor, &segmentCursor, &triggerCursor };
+	for (std::size_t i = 0; i < 3; ++i)
+	{
+		lists[i]->chunk = static_cast<std::size_t>(cursors[i * 2]);
+		lists[i]->index = static_cast<std::size_t>(cursors[i * 2 + 1]);
+	}
+}
+
+void LevelStream::request(std::size_t index)
+{
+	if (resident.find(index) != resident.end())
+		return;
+
+	const ChunkInfo info = chunks[index];
+	const std::string file = filename;
+
+	Slot slot;
+	slot.chunk = std::make_shared<LevelChunk>();
+	std::shared_ptr<LevelChunk> target = slot.chunk;
+	slot.loading = workers.enqueue([file, info, target]()
+	{
+		*target = std::move(*readChunk(file, info.offset, info.spawnCount, info.segmentCount, info.triggerCount));
+	});
+	resident.emplace(index, std::move(slot));
+}
+
+const LevelChunk& LevelStream::acquire(std::size_t index)
+{
+	request(index);
+
+	Slot& slot = resident[index];
+	// Rethrows read errors from the worker
+	if (slot.loading.valid())
+		slot.loading.get();
+	return *slot.chunk;
+}
+
+std::size_t LevelStream::chunkAt(float distance) const
+{
+	if (distance <= 0.f)
+		return 0;
+	return std::min(static_cast<std::size_t>(distance / chunkLength), chunks.size() - 1);
+}
+
+template <typename T>
+void LevelStream::pop(Cursor& cursor, std::vector<T> LevelChunk::* events, float distance, std::vector<T>& output)
+{
+	std::size_t last = chunkAt(distance);
+	while (cursor.chunk < chunks.size() && cursor.chunk <= last)
+	{
+		const std::vector<T>& list = acquire(cursor.chunk).*events;
+		while (cursor.index < list.size() && list[cursor.index].distance <= distance)
+			output.push_back(list[cursor.index++]);
+
+		if (cursor.index < list.size())
+			return;
+
+		cursor.chunk += 1;
+		cursor.index = 0;
+	}
+}
+
+void compileLevel(const std::string& source, const std::string& binary)
+{
+	std::ifstream in(source);
+	if (!in)
+		throw std::runtime_error("compileLevel - Failed to open " + source);
+
+	float stageLength = 0.f;
+	float chunkLength = 0.f;
+	std::vector<SpawnEvent> spawns;
+	std::vector<BackgroundSegment> segments;
+	std::vector<LevelTrigger> triggers;
+
+	std::string line;
+	for (int lineNumber = 1; std::getline(in, line); ++lineNumber)
+	{
+		std::istringstream fields(line);
+		std::string kind, name;
+		if (!(fields >> kind) || kind[0] == '#')
+			continue;
+
+		const std::string where = source + ":" + std::to_string(lineNumber);
+		const std::string malformed = where + ": missing or malformed value";
+
+		if (kind == "stage")
+		{
+			if (!(fields >> stageLength >> chunkLength) || stageLength <= 0.f || chunkLength <= 0.f)
+				throw std::runtime_error(malformed);
+		}
+		else if (kind == "spawn")
+		{
+			SpawnEvent spawn;
+			spawn.request.formation = Formation::Single;
+			spawn.request.count = 1;
+			spawn.request.spacing = 0.f;
+			spawn.delay = 0.f;
+			spawn.timed = false;
+			std::string trigger;
+			if (!(fields >> name >> spawn.request.x >> trigger))
+				throw std::runtime_error(malformed);
+			spawn.request.type = parseAircraftType(name, where);
+
+			// A distance, or "at <seconds>" since the level started
+			if (trigger == "at")
+			{
+				spawn.distance = 0.f;
+				spawn.timed = true;
+				if (!(fields >> spawn.delay) || spawn.delay < 0.f)
+					throw std::runtime_error(malformed);
+			}
+			else
+			{
+				std::istringstream distance(trigger);
+				if (!(distance >> spawn.distance) || !distance.eof())
+					throw std::runtime_error(malformed);
+			}
+
+			// Optional: "after <seconds>" and "<formation> <count> <spacing>"
+			std::string option;
+			while (fields >> option)
+			{
+				if (option == "after")
+				{
+					if (spawn.timed || !(fields >> spawn.delay))
+						throw std::runtime_error(malformed);
+				}
+				else
+				{
+					spawn.request.formation = parseName<Formation>(FormationNames, option, where);
+					if (!(fields >> spawn.request.count >> spawn.request.spacing) || spawn.request.count == 0)
+						throw std::runtime_error(malformed);
+				}
+			}
+			spawns.push_back(spawn);
+		}
+		else if (kind == "background")
+		{
+			BackgroundSegment segment;
+			if (!(fields >> name >> segment.distance >> segment.length))
+				throw std::runtime_error(malformed);
+			if (!(fields >> segment.blend))
+				segment.blend = 0.f;
+			segment.texture = parseTextureID(name, where);
+			segments.push_back(segment);
+		}
+		else if (kind == "trigger")
+		{
+			LevelTrigger trigger;
+			if (!(fields >> name >> trigger.distance >> trigger.value))
+				throw std::runtime_error(malformed);
+			trigger.type = parseName<LevelTrigger::Type>(TriggerNames, name, where);
+			triggers.push_back(trigger);
+		}
+		else
+		{
+			throw std::runtime_error(where + ": unknown entry \"" + kind + "\"");
+		}
+	}
+
+	if (chunkLength <= 0.f)
+		throw std::runtime_error(source + ": missing stage entry");
+
+	// Bucket every event into the chunk its distance falls in
+	auto chunkOf = [&](float distance)
+	{
+		return distance <= 0.f ? std::size_t(0) : static_cast<std::size_t>(distance / chunkLength);
+	};
+
+	std::size_t chunkCount = std::max<std::size_t>(static_cast<std::size_t>(std::ceil(stageLength / chunkLength)), 1);
+	for (const SpawnEvent& spawn : spawns)
+		chunkCount = std::max(chunkCount, chunkOf(spawn.distance) + 1);
+	for (const BackgroundSegment& segment : segments)
+		chunkCount = std::max(chunkCount, chunkOf(segment.distance) + 1);
+	for (const LevelTrigger& trigger : triggers)
+		chunkCount = std::max(chunkCount, chunkOf(trigger.distance) + 1);
+
+	std::vector<LevelChunk> chunks(chunkCount);
+	for (const SpawnEvent& spawn : spawns)
+		chunks[chunkOf(spawn.distance)].spawns.push_back(spawn);
+	for (const BackgroundSegment& segment : segments)
+		chunks[chunkOf(segment.distance)].segments.push_back(segment);
+	for (const LevelTrigger& trigger : triggers)
+		chunks[chunkOf(trigger.distance)].triggers.push_back(trigger);
+
+	std::ofstream out(binary, std::ios::binary | std::ios::trunc);
+	if (!out)
+		throw std::runtime_error("compileLevel - Failed to write " + binary);
+
+	FileHeader header;
+	header.magic = Magic;
+	header.version = Version;
+	header.stageLength = stageLength;
+	header.chunkLength = chunkLength;
+	header.chunkCount = static_cast<std::uint32_t>(chunkCount);
+	writeRecord(out, header);
+
+	std::uint64_t offset = sizeof(FileHeader) + chunkCount * sizeof(ChunkRecord);
+	for (LevelChunk& chunk : chunks)
+	{
+		sortByDistance(chunk.spawns);
+		sortByDistance(chunk.segments);
+		sortByDistance(chunk.triggers);
+
+		ChunkRecord record;
+		record.offset = offset;
+		record.spawnCount = static_cast<std::uint32_t>(chunk.spawns.size());
+		record.segmentCount = static_cast<std::uint32_t>(chunk.segments.size());
+		record.triggerCount = static_cast<std::uint32_t>(chunk.triggers.size());
+		record.padding = 0;
+		writeRecord(out, record);
+
+		offset += record.spawnCount * sizeof(SpawnRecord)
+			+ record.segmentCount * sizeof(SegmentRecord)
+			+ record.triggerCount * sizeof(TriggerRecord);
+	}
+
+	for (const LevelChunk& chunk : chunks)
+	{
+		for (const SpawnEvent& spawn : chunk.spawns)
+		{
+			SpawnRecord record;
+			record.type = static_cast<std::int32_t>(spawn.request.type);
+			record.x = spawn.request.x;
+			record.distance = spawn.distance;
+			record.delay = spawn.delay;
+			record.formation = static_cast<std::int32_t>(spawn.request.formation);
+			record.count = static_cast<std::uint32_t>(spawn.request.count);
+			record.spacing = spawn.request.spacing;
+			record.timed = spawn.timed ? 1 : 0;
+			writeRecord(out, record);
+		}
+		for (const BackgroundSegment& segment : chunk.segments)
+			writeRecord(out, SegmentRecord{ static_cast<std::int32_t>(segment.texture), segment.distance, segment.length, segment.blend });
+		for (const LevelTrigger& trigger : chunk.triggers)
+			writeRecord(out, TriggerRecord{ static_cast<std::int32_t>(trigger.type), trigger.distance, trigger.value });
+	}
+}
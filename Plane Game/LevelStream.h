@@ -0,0 +1,126 @@
+#pragma once
+#include "SpawnScheduler.h"
+#include "ResourceIdentifier.h"
+
+#include <SFML/System/NonCopyable.hpp>
+
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Level positions are distances along the scroll axis, measured up from
+// the bottom of the stage
+struct SpawnEvent
+{
+	SpawnRequest				request;
+	float						distance;
+	// Seconds after the distance is reached; for timed spawns seconds since
+	// the level started, and distance 0 so they are handed out first
+	float						delay;
+	bool						timed;
+};
+
+struct BackgroundSegment
+{
+	TextureID					texture;
+	float						distance;
+	float						length;
+	// Distance over which it fades in above the previous segment
+	float						blend;
+};
+
+struct LevelTrigger
+{
+	enum class Type
+	{
+		ScrollSpeed,
+		TypeCount
+	};
+
+	Type						type;
+	float						distance;
+	float						value;
+};
+
+// Everything starting inside one slice of the stage, sorted by distance
+struct LevelChunk
+{
+	std::vector<SpawnEvent>			spawns;
+	std::vector<BackgroundSegment>	segments;
+	std::vector<LevelTrigger>		triggers;
+};
+
+// Streams a chunked level file. Chunks ahead of the camera are read on the
+// thread pool, chunks behind it are dropped, so memory stays the same for
+// any stage length. Events come out in level order, each exactly once.
+class LevelStream : private sf::NonCopyable
+{
+public:
+								LevelStream(ThreadPool& workers, const std::string& source, const std::string& binary);
+
+	float						getStageLength() const;
+	std::size_t					getResidentChunkCount() const;
+
+	// Requests chunks up to lookahead and releases the ones fully behind camera
+	void						update(float camera, float lookahead);
+
+	// A chunk that is still loading is waited for, so results never depend
+	// on disk or thread timing
+	void						popSpawns(float distance, std::vector<SpawnEvent>& output);
+	void						popSegments(float distance, std::vector<BackgroundSegment>& output);
+	void						popTriggers(float distance, std::vector<LevelTrigger>& output);
+
+	// Read positions of the spawn, segment and trigger lists, as (chunk, index)
+	// pairs; seek() puts them back and reloads chunks on demand
+	void						getCursors(std::uint64_t (&cursors)[6]) const;
+	void						seek(const std::uint64_t (&cursors)[6]);
+
+private:
+	struct ChunkInfo
+	{
+		std::uint64_t				offset;
+		std::uint32_t				spawnCount;
+		std::uint32_t				segmentCount;
+		std::uint32_t				triggerCount;
+	};
+
+	struct Slot
+	{
+		std::shared_ptr<LevelChunk>	chunk;
+		std::future<void>			loading;
+	};
+
+	struct Cursor
+	{
+		std::size_t					chunk;
+		std::size_t					index;
+	};
+
+private:
+	void						request(std::size_t index);
+	const LevelChunk&			acquire(std::size_t index);
+	std::size_t					chunkAt(float distance) const;
+
+	template <typename T>
+	void						pop(Cursor& cursor, std::vector<T> LevelChunk::* events, float distance, std::vector<T>& output);
+
+private:
+	ThreadPool&					workers;
+	std::string					filename;
+	float						stageLength;
+	float						chunkLength;
+	std::vector<ChunkInfo>		chunks;
+	std::map<std::size_t, Slot>	resident;
+
+	Cursor						spawnCursor;
+	Cursor						segmentCursor;
+	Cursor						triggerCursor;
+};
+
+// Builds the binary level from its text source, throws on errors
+void							compileLevel(const std::string& source, const std::string& binary);
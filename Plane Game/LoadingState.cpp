@@ -0,0 +1,72 @@
+#include "LoadingState.h"
+#include "Utility.h"
+#include "ResourceHolder.h"
+#include "ResourceLoader.h"
+
+#include <SFML/Graphics/RenderWindow.hpp>
+
+namespace
+{
+	// Main thread time spent finishing loads per tick, keeps the screen responsive
+	const sf::Time UploadBudget = sf::milliseconds(8);
+}
+
+LoadingState::LoadingState(StateStack& stack, Context context)
+	:State(stack, context)
+	,loadingText()
+	,progressBarBackground()
+	,progressBar()
+{
+	sf::Vector2f viewSize = context.window->getView().getSize();
+
+	loadingText.setFont(context.fonts->get(FontID::Main));
+	loadingText.setString("Loading Resources");
+	centerOrigin(loadingText);
+	loadingText.setPosition(viewSize.x / 2.f, viewSize.y / 2.f + 50.f);
+
+	progressBarBackground.setFillColor(sf::Color::White);
+	progressBarBackground.setSize(sf::Vector2f(viewSize.x - 20.f, 10.f));
+	progressBarBackground.setPosition(10.f, loadingText.getPosition().y + 40.f);
+
+	progressBar.setFillColor(sf::Color(100, 100, 100));
+	progressBar.setSize(sf::Vector2f(0.f, 10.f));
+	progressBar.setPosition(progressBarBackground.getPosition());
+
+	setProgress(context.loader->getProgress());
+}
+
+void LoadingState::draw()
+{
+	auto& window = *getContext().window;
+	window.setView(window.getDefaultView());
+
+	window.draw(loadingText);
+	window.draw(progressBarBackground);
+	window.draw(progressBar);
+}
+
+bool LoadingState::update(sf::Time dt)
+{
+	ResourceLoader& loader = *getContext().loader;
+	loader.update(UploadBudget);
+	setProgress(loader.getProgress());
+
+	if (loader.isIdle())
+		requestStackPop();
+
+	// States below wait until loading is done
+	return false;
+}
+
+bool LoadingState::handleEvents(const sf::Event& event)
+{
+	return false;
+}
+
+void LoadingState::setProgress(float percent)
+{
+	progressBar.setSize(sf::Vector2f(progressBarBackground.getSize().x * percent, progressBar.getSize().y));
+
+	loadingText.setString("Loading Resources " + std::to_string(static_cast<int>(percent * 100.f)) + "%");
+	centerOrigin(loadingText);
+}
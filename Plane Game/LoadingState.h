@@ -0,0 +1,24 @@
+#pragma once
+#include "State.h"
+#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/Text.hpp>
+
+// Sits on top of the stack while the resource loader has work queued,
+// finishing uploads each tick and popping itself once the loader is idle
+class LoadingState : public State
+{
+public:
+							LoadingState(StateStack& stack, Context context);
+
+	virtual void			draw() override;
+	virtual bool			update(sf::Time dt) override;
+	virtual bool			handleEvents(const sf::Event& event) override;
+
+private:
+	void					setProgress(float percent);
+
+private:
+	sf::Text				loadingText;
+	sf::RectangleShape		progressBarBackground;
+	sf::RectangleShape		progressBar;
+};
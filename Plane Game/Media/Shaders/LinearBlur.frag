@@ -0,0 +1,15 @@
+uniform sampler2D 	source;
+uniform vec2 		offsetFactor;
+
+// Same 9-tap kernel as GuassianBlur.frag, folded into 5 fetches by
+// sampling between texel pairs and letting bilinear filtering weight them
+void main()
+{
+	vec2 textureCoordinates = gl_TexCoord[0].xy;
+	vec4 color = texture2D(source, textureCoordinates) * 0.2270270270;
+	color += texture2D(source, textureCoordinates + 1.3846153846 * offsetFactor) * 0.3162162162;
+	color += texture2D(source, textureCoordinates - 1.3846153846 * offsetFactor) * 0.3162162162;
+	color += texture2D(source, textureCoordinates + 3.2307692308 * offsetFactor) * 0.0702702703;
+	color += texture2D(source, textureCoordinates - 3.2307692308 * offsetFactor) * 0.0702702703;
+	gl_FragColor = color;
+}
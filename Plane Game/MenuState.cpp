@@ -59,6 +59,7 @@ bool MenuState::handleEvents(const sf::Event& event)
 		if (mOptionIndex == Play) {
 			requestStackPop();
 			requestStackPush(StateID::Game);
+			requestStackPush(StateID::Loading);
 		}
 		else if (mOptionIndex == Exit) {
 			requestStackPop();
@@ -0,0 +1,154 @@
+#include "MovementSystem.h"
+#include "DataTables.h"
+
+#include <cassert>
+
+namespace
+{
+	// Reloaded in place when the entity tables change
+	const AircraftTable& TABLE = entityTables().aircraft;
+}
+
+MovementSystem::MovementSystem()
+	: patterns()
+	, stepX()
+	, stepY()
+	, stepDistance()
+	, types()
+	, directionIndices()
+	, travelledDistances()
+	, velocityX()
+	, velocityY()
+	, owners()
+{
+	rebuildPatterns();
+}
+
+void MovementSystem::add(Aircraft::Type type, float travelledDistance, std::size_t directionIndex, std::size_t& slot)
+{
+	slot = types.size();
+	types.push_back(static_cast<std::uint8_t>(type));
+	directionIndices.push_back(static_cast<std::uint32_t>(directionIndex));
+	travelledDistances.push_back(travelledDistance);
+	velocityX.push_back(0.f);
+	velocityY.push_back(0.f);
+	owners.push_back(&slot);
+}
+
+void MovementSystem::remove(std::size_t slot)
+{
+	assert(slot < types.size());
+
+	// The last entry fills the hole, its owner learns the new slot
+	std::size_t last = types.size() - 1;
+	if (slot != last)
+	{
+		types[slot] = types[last];
+		directionIndices[slot] = directionIndices[last];
+		travelledDistances[slot] = travelledDistances[last];
+		velocityX[slot] = velocityX[last];
+		velocityY[slot] = velocityY[last];
+		owners[slot] = owners[last];
+		*owners[slot] = slot;
+	}
+
+	types.pop_back();
+	directionIndices.pop_back();
+	travelledDistances.pop_back();
+	velocityX.pop_back();
+	velocityY.pop_back();
+	owners.pop_back();
+}
+
+void MovementSystem::update(sf::Time dt)
+{
+	const float seconds = dt.asSeconds();
+	const std::size_t count = types.size();
+
+	// Same steps as the old per aircraft update: switch direction once the
+	// step's distance is covered, then move along the current step. The step
+	// lookups are gathers and types without directions are skipped, so this
+	// stays a scalar loop; it gains from the precomputed headings and the
+	// dense arrays.
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const Pattern pattern = patterns[types[i]];
+		if (pattern.count == 0)
+			continue;
+
+		// The pattern may have shrunk in a table reload
+		std::uint32_t index = directionIndices[i] < pattern.count ? directionIndices[i] : 0;
+		float travelled = travelledDistances[i];
+
+		bool next = travelled > stepDistance[pattern.first + index];
+		std::uint32_t following = index + 1 < pattern.count ? index + 1 : 0;
+		index = next ? following : index;
+		travelled = next ? 0.f : travelled;
+
+		std::uint32_t step = pattern.first + index;
+		velocityX[i] = pattern.speed * stepX[step];
+		velocityY[i] = pattern.speed * stepY[step];
+		travelledDistances[i] = travelled + pattern.speed * seconds;
+		directionIndices[i] = index;
+	}
+
+	if (seconds <= 0.f)
+		return;
+
+	// Flight paths: the velocity that lands exactly on the path's next
+	// position, so the scene update keeps the aircraft on the curve
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const Pattern pattern = patterns[types[i]];
+		if (!pattern.path)
+			continue;
+
+		float travelled = travelledDistances[i];
+		float next = travelled + pattern.speed * seconds;
+		sf::Vector2f step = pattern.path->getPosition(next) - pattern.path->getPosition(travelled);
+		velocityX[i] = step.x / seconds;
+		velocityY[i] = step.y / seconds;
+		travelledDistances[i] = next;
+	}
+}
+
+sf::Vector2f MovementSystem::getVelocity(std::size_t slot) const
+{
+	return sf::Vector2f(velocityX[slot], velocityY[slot]);
+}
+
+float MovementSystem::getTravelledDistance(std::size_t slot) const
+{
+	return travelledDistances[slot];
+}
+
+std::size_t MovementSystem::getDirectionIndex(std::size_t slot) const
+{
+	return directionIndices[slot];
+}
+
+std::size_t MovementSystem::getCount() const
+{
+	return types.size();
+}
+
+void MovementSystem::rebuildPatterns()
+{
+	stepX.clear();
+	stepY.clear();
+	stepDistance.clear();
+
+	for (std::size_t i = 0; i < TypeCount; ++i)
+	{
+		const AircraftData& data = TABLE[static_cast<Aircraft::Type>(i)];
+		patterns[i] = { static_cast<std::uint32_t>(stepX.size()), static_cast<std::uint32_t>(data.directions.size()), data.speed,
+			data.path.isEmpty() ? nullptr : &data.path };
+
+		for (const Direction& direction : data.directions)
+		{
+			stepX.push_back(direction.heading.x);
+			stepY.push_back(direction.heading.y);
+			stepDistance.push_back(direction.distance);
+		}
+	}
+}
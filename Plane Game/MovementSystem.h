@@ -0,0 +1,63 @@
+#pragma once
+#include "Aircraft.h"
+
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class FlightPath;
+
+// Moves every patrolling aircraft along its table pattern or flight path, one
+// pass per tick for each. Pattern state lives here in parallel arrays rather than in the
+// aircraft; each owner keeps a slot index, rewritten when slots move.
+class MovementSystem : private sf::NonCopyable
+{
+public:
+								MovementSystem();
+
+	// slot is the owner's field and must stay valid until remove. On a flight
+	// path the travelled distance is the distance along it.
+	void						add(Aircraft::Type type, float travelledDistance, std::size_t directionIndex, std::size_t& slot);
+	void						remove(std::size_t slot);
+
+	// Before the scene update, so aircraft pick up their velocity in it
+	void						update(sf::Time dt);
+
+	sf::Vector2f				getVelocity(std::size_t slot) const;
+	float						getTravelledDistance(std::size_t slot) const;
+	std::size_t					getDirectionIndex(std::size_t slot) const;
+	std::size_t					getCount() const;
+
+	// After the entity tables reload, and once on construction
+	void						rebuildPatterns();
+
+private:
+	struct Pattern
+	{
+		std::uint32_t			first;
+		std::uint32_t			count;
+		float					speed;
+		const FlightPath*		path;
+	};
+
+	static const std::size_t	TypeCount = static_cast<std::size_t>(Aircraft::Type::TypeCount);
+
+private:
+	// Every type's steps back to back
+	std::array<Pattern, TypeCount>	patterns;
+	std::vector<float>			stepX;
+	std::vector<float>			stepY;
+	std::vector<float>			stepDistance;
+
+	// One entry per aircraft
+	std::vector<std::uint8_t>	types;
+	std::vector<std::uint32_t>	directionIndices;
+	std::vector<float>			travelledDistances;
+	std::vector<float>			velocityX;
+	std::vector<float>			velocityY;
+	std::vector<std::size_t*>	owners;
+};
@@ -1,40 +1,168 @@
 #include "MusicPlayer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
 
-MusicPlayer::MusicPlayer()
-	: music()
+namespace
+{
+	const sf::Time CrossfadeTime = sf::seconds(1.5f);
+
+	// Short enough to feel instant, long enough not to click
+	const sf::Time PauseFadeTime = sf::seconds(0.15f);
+
+	float approach(float value, float target, float step)
+	{
+		if (value < target)
+			return std::min(value + step, target);
+		return std::max(value - step, target);
+	}
+}
+
+MusicPlayer::MusicPlayer(ThreadPool& workers)
+	: workers(workers)
+	, decks()
+	, current(nullptr)
+	, pending(nullptr)
 	, filenames()
 	, volume(100.f)
+	, paused(false)
+	, pauseGain(1.f)
 {
 	filenames[MusicID::MenuTheme] = "Media/Music/MenuTheme.ogg";
 	filenames[MusicID::MissionTheme] = "Media/Music/MissionTheme.ogg";
+
+	for (Deck& deck : decks)
+	{
+		deck.theme = MusicID::MusicCount;
+		deck.gain = 0.f;
+		deck.target = 0.f;
+	}
+
+	// Both themes fit in the two decks, so neither is ever opened on a transition
+	prepare(MusicID::MenuTheme);
+	prepare(MusicID::MissionTheme);
+}
+
+MusicPlayer::~MusicPlayer()
+{
+	// Workers may still be opening into our decks
+	for (Deck& deck : decks)
+		if (deck.opening.valid())
+			deck.opening.wait();
+}
+
+void MusicPlayer::prepare(MusicID theme)
+{
+	if (findDeck(theme))
+		return;
+
+	// Reuse the deck that is not playing, or the older one if neither is
+	Deck& deck = (current == &decks[0]) ? decks[1] : decks[0];
+	if (isOpening(deck))
+		deck.opening.wait();
+	deck.music.stop();
+	deck.gain = 0.f;
+	deck.target = 0.f;
+	deck.theme = theme;
+
+	sf::Music& music = deck.music;
+	std::string filename = filenames[theme];
+	deck.opening = workers.enqueue([&music, filename]()
+	{
+		return music.openFromFile(filename);
+	});
+
+	if (pending == &deck)
+		pending = nullptr;
 }
 
 void MusicPlayer::play(MusicID theme)
 {
-	auto filename = filenames[theme];
+	if (current && current->theme == theme && current->target > 0.f)
+		return;
 
-	if (!music.openFromFile(filename))
-		throw std::runtime_error("Music " + filename + "could not be loaded");
+	prepare(theme);
+	if (current)
+		current->target = 0.f;
 
-	music.setVolume(volume);
-	music.setLoop(true);
-	music.play();
+	pending = findDeck(theme);
+	current = nullptr;
 }
 
 void MusicPlayer::stop()
 {
-	music.stop();
+	for (Deck& deck : decks)
+		deck.target = 0.f;
+	current = nullptr;
+	pending = nullptr;
+}
+
+void MusicPlayer::update(sf::Time dt)
+{
+	if (pending && !isOpening(*pending))
+	{
+		start(*pending);
+		current = pending;
+		pending = nullptr;
+	}
+
+	pauseGain = approach(pauseGain, paused ? 0.f : 1.f, dt / PauseFadeTime);
+	const float step = dt / CrossfadeTime;
+
+	for (Deck& deck : decks)
+	{
+		if (isOpening(deck) || deck.music.getStatus() == sf::Music::Stopped)
+			continue;
+
+		deck.gain = approach(deck.gain, deck.target, step);
+		deck.music.setVolume(volume * deck.gain * pauseGain);
+
+		if (deck.gain == 0.f && deck.target == 0.f)
+			deck.music.stop();
+		else if (pauseGain == 0.f && deck.music.getStatus() == sf::Music::Playing)
+			deck.music.pause();
+		else if (!paused && deck.music.getStatus() == sf::Music::Paused)
+			deck.music.play();
+	}
 }
 
 void MusicPlayer::setPaused(bool paused)
 {
-	if (paused)
-		music.pause();
-	else
-		music.play();
+	this->paused = paused;
 }
 
 void MusicPlayer::setVolume(float vol)
 {
 	volume = vol;
 }
+
+MusicPlayer::Deck* MusicPlayer::findDeck(MusicID theme)
+{
+	for (Deck& deck : decks)
+		if (deck.theme == theme)
+			return &deck;
+	return nullptr;
+}
+
+bool MusicPlayer::isOpening(const Deck& deck) const
+{
+	return deck.opening.valid()
+		&& deck.opening.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+void MusicPlayer::start(Deck& deck)
+{
+	if (deck.opening.valid() && !deck.opening.get())
+		throw std::runtime_error("Music " + filenames[deck.theme] + " could not be loaded");
+
+	deck.target = 1.f;
+
+	// A deck still fading out is simply faded back in
+	if (deck.music.getStatus() == sf::Music::Stopped)
+	{
+		deck.gain = 0.f;
+		deck.music.setLoop(true);
+		deck.music.setVolume(0.f);
+		deck.music.play();
+	}
+}
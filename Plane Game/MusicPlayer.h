@@ -2,27 +2,55 @@
 #include "ResourceHolder.h"
 #include "ResourceIdentifier.h"
 #include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
 #include <SFML/Audio/Music.hpp>
+#include <array>
+#include <future>
 #include <map>
 #include <string>
 
+class ThreadPool;
+
+// Two decks: themes are opened on a worker ahead of time, and changing theme
+// crossfades from the playing deck to the other one. Pausing only sets a
+// flag, the fade and the stream calls happen in update().
 class MusicPlayer : private sf::NonCopyable
 {
 public:
-										MusicPlayer();
+	explicit							MusicPlayer(ThreadPool& workers);
+										~MusicPlayer();
 
+	// Opens a theme in the idle deck in the background
+	void								prepare(MusicID theme);
 	void								play(MusicID theme);
 	void								stop();
+	void								update(sf::Time dt);
 
 	void								setPaused(bool paused);
 	void								setVolume(float vol);
 
 private:
-	sf::Music							music;
-	std::map<MusicID, std::string>		filenames;
-	float								volume;
+	struct Deck
+	{
+		sf::Music							music;
+		MusicID								theme;
+		std::future<bool>					opening;
+		float								gain;
+		float								target;
+	};
 
+private:
+	Deck*								findDeck(MusicID theme);
+	bool								isOpening(const Deck& deck) const;
+	void								start(Deck& deck);
 
+private:
+	ThreadPool&							workers;
+	std::array<Deck, 2>					decks;
+	Deck*								current;
+	Deck*								pending;
+	std::map<MusicID, std::string>		filenames;
+	float								volume;
+	bool								paused;
+	float								pauseGain;
 };
-
-
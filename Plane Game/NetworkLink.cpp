@@ -0,0 +1,93 @@
+#include "NetworkLink.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	const std::size_t UdpHeaderSize = 28;
+}
+
+NetworkLink::NetworkLink(unsigned short port)
+	: socket()
+	, receiveBuffer(sf::UdpSocket::MaxDatagramSize)
+	, clock()
+	, lossRate(0.f)
+	, latency(sf::Time::Zero)
+	, jitter(sf::Time::Zero)
+	// Its own seed, the shim must not disturb the mission's streams
+	, random(generateSeed(), 0)
+	, heldPackets()
+	, bytesSent(0)
+{
+	if (socket.bind(port) != sf::Socket::Done)
+		throw std::runtime_error("NetworkLink::NetworkLink - Failed to bind UDP port " + std::to_string(port));
+	socket.setBlocking(false);
+}
+
+void NetworkLink::setConditions(float lossRate, sf::Time latency, sf::Time jitter)
+{
+	this->lossRate = lossRate;
+	this->latency = latency;
+	this->jitter = jitter;
+}
+
+void NetworkLink::send(const std::vector<char>& data, const sf::IpAddress& address, unsigned short port)
+{
+	bytesSent += data.size() + UdpHeaderSize;
+
+	if (lossRate > 0.f && random.nextFloat() < lossRate)
+		return;
+
+	if (latency == sf::Time::Zero && jitter == sf::Time::Zero)
+	{
+		transmit(data, address, port);
+		return;
+	}
+
+	// Jitter can reorder packets, as a real network would
+	sf::Time delay = latency + jitter * random.nextFloat();
+	heldPackets.push_back({ clock.getElapsedTime() + delay, data, address, port });
+}
+
+bool NetworkLink::receive(std::vector<char>& data, sf::IpAddress& address, unsigned short& port)
+{
+	std::size_t received = 0;
+	if (socket.receive(receiveBuffer.data(), receiveBuffer.size(), received, address, port) != sf::Socket::Done)
+		return false;
+
+	data.assign(receiveBuffer.begin(), receiveBuffer.begin() + received);
+	return true;
+}
+
+void NetworkLink::update()
+{
+	sf::Time now = clock.getElapsedTime();
+
+	auto due = std::stable_partition(heldPackets.begin(), heldPackets.end(), [now](const HeldPacket& packet)
+	{
+		return packet.due > now;
+	});
+	for (auto packet = due; packet != heldPackets.end(); ++packet)
+		transmit(packet->data, packet->address, packet->port);
+	heldPackets.erase(due, heldPackets.end());
+}
+
+void NetworkLink::flush()
+{
+	for (const HeldPacket& packet : heldPackets)
+		transmit(packet.data, packet.address, packet.port);
+	heldPackets.clear();
+}
+
+std::size_t NetworkLink::getBytesSent() const
+{
+	return bytesSent;
+}
+
+void NetworkLink::transmit(const std::vector<char>& data, const sf::IpAddress& address, unsigned short port)
+{
+	// A full send buffer drops the packet, which the protocol already survives
+	socket.send(data.data(), data.size(), address, port);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "Random.h"
+
+#include <SFML/Network/UdpSocket.hpp>
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <vector>
+
+// Non-blocking UDP socket. Outgoing packets can be dropped and delayed on
+// purpose, so co-op can be tried over localhost under bad conditions.
+class NetworkLink : private sf::NonCopyable
+{
+public:
+	// AnyPort lets the system pick, which is what clients want
+	explicit						NetworkLink(unsigned short port = sf::Socket::AnyPort);
+
+	// lossRate in [0, 1]; each packet is held for latency plus up to jitter
+	void							setConditions(float lossRate, sf::Time latency, sf::Time jitter);
+
+	void							send(const std::vector<char>& data, const sf::IpAddress& address, unsigned short port);
+	// False once nothing is waiting
+	bool							receive(std::vector<char>& data, sf::IpAddress& address, unsigned short& port);
+	// Sends the held packets that are due
+	void							update();
+	// Sends every held packet now, before the link goes away
+	void							flush();
+
+	// Including the IP and UDP headers, dropped packets count too
+	std::size_t						getBytesSent() const;
+
+private:
+	struct HeldPacket
+	{
+		sf::Time					due;
+		std::vector<char>			data;
+		sf::IpAddress				address;
+		unsigned short				port;
+	};
+
+private:
+	void							transmit(const std::vector<char>& data, const sf::IpAddress& address, unsigned short port);
+
+private:
+	sf::UdpSocket					socket;
+	std::vector<char>				receiveBuffer;
+	sf::Clock						clock;
+
+	float							lossRate;
+	sf::Time						latency;
+	sf::Time						jitter;
+	RandomStream					random;
+	std::vector<HeldPacket>			heldPackets;
+
+	std::size_t						bytesSent;
+};
@@ -0,0 +1,18 @@
+#include "NetworkSettings.h"
+
+namespace
+{
+	const unsigned short DefaultPort = 53000;
+}
+
+NetworkSettings::NetworkSettings()
+	: role(Role::Offline)
+	, hostAddress(sf::IpAddress::LocalHost)
+	, port(DefaultPort)
+	, rollback(false)
+	, lossRate(0.f)
+	, latency(sf::Time::Zero)
+	, jitter(sf::Time::Zero)
+{
+}
+
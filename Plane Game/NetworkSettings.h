@@ -0,0 +1,27 @@
+#pragma once
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/System/Time.hpp>
+
+// Chosen on the command line, Offline is the normal single player game
+struct NetworkSettings
+{
+	enum class Role
+	{
+		Offline,
+		Host,
+		Client,
+	};
+
+									NetworkSettings();
+
+	Role							role;
+	sf::IpAddress					hostAddress;
+	unsigned short					port;
+	// Both peers simulate with rollback instead of the host sending state
+	bool							rollback;
+
+	// Loss and latency shim, applied to what this side sends
+	float							lossRate;
+	sf::Time						latency;
+	sf::Time						jitter;
+};
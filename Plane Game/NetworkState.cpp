@@ -0,0 +1,323 @@
+#include "NetworkState.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+	// Error allowed before a moving entity is sent again, half a pixel
+	const std::int32_t PositionTolerance = PositionScale / 2;
+
+	enum Field
+	{
+		PositionField	= 1 << 0,
+		VelocityField	= 1 << 1,
+		RotationField	= 1 << 2,
+		HitpointsField	= 1 << 3,
+		FieldCount		= 4,
+	};
+
+	class BitWriter
+	{
+	public:
+		explicit BitWriter(std::vector<char>& output)
+			: output(output)
+			, bit(0)
+		{
+			output.clear();
+		}
+
+		void write(std::uint32_t value, unsigned int bits)
+		{
+			for (unsigned int i = 0; i < bits; ++i)
+			{
+				if (bit % 8 == 0)
+					output.push_back(0);
+				if (value & (1u << i))
+					output.back() |= static_cast<char>(1u << (bit % 8));
+				bit += 1;
+			}
+		}
+
+		// 6 bit length prefix, then that many bits of the value
+		void writeUnsigned(std::uint32_t value)
+		{
+			unsigned int bits = 0;
+			while (bits < 32 && (value >> bits) != 0)
+				bits += 1;
+			write(bits, 6);
+			write(value, bits);
+		}
+
+		// Zigzag keeps small negative values short
+		void writeSigned(std::int32_t value)
+		{
+			writeUnsigned((static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31));
+		}
+
+	private:
+		std::vector<char>&	output;
+		std::size_t			bit;
+	};
+
+	class BitReader
+	{
+	public:
+		BitReader(const char* data, std::size_t size)
+			: data(data)
+			, size(size)
+			, bit(0)
+			, failed(false)
+		{
+		}
+
+		std::uint32_t read(unsigned int bits)
+		{
+			std::uint32_t value = 0;
+			for (unsigned int i = 0; i < bits; ++i)
+			{
+				if (bit >= size * 8)
+				{
+					failed = true;
+					return 0;
+				}
+				if (static_cast<unsigned char>(data[bit / 8]) & (1u << (bit % 8)))
+					value |= 1u << i;
+				bit += 1;
+			}
+			return value;
+		}
+
+		std::uint32_t readUnsigned()
+		{
+			unsigned int bits = read(6);
+			if (bits > 32)
+			{
+				failed = true;
+				return 0;
+			}
+			return read(bits);
+		}
+
+		std::int32_t readSigned()
+		{
+			std::uint32_t zigzag = readUnsigned();
+			return static_cast<std::int32_t>(zigzag >> 1) ^ -static_cast<std::int32_t>(zigzag & 1);
+		}
+
+		bool hasFailed() const
+		{
+			return failed;
+		}
+
+	private:
+		const char*		data;
+		std::size_t		size;
+		std::size_t		bit;
+		bool			failed;
+	};
+
+	std::int32_t predict(std::int32_t position, std::int32_t velocity, std::uint32_t ticks)
+	{
+		return position + static_cast<std::int32_t>(static_cast<std::int64_t>(velocity) * ticks / NetworkTicksPerSecond);
+	}
+
+	NetworkEntity extrapolate(const NetworkEntity& entity, std::uint32_t ticks)
+	{
+		NetworkEntity moved = entity;
+		moved.x = predict(entity.x, entity.vx, ticks);
+		moved.y = predict(entity.y, entity.vy, ticks);
+		return moved;
+	}
+
+	unsigned int changedFields(const NetworkEntity& current, const NetworkEntity& predicted)
+	{
+		unsigned int fields = 0;
+		if (std::abs(current.x - predicted.x) > PositionTolerance || std::abs(current.y - predicted.y) > PositionTolerance)
+			fields |= PositionField;
+		if (current.vx != predicted.vx || current.vy != predicted.vy)
+			fields |= VelocityField;
+		if (current.rotation != predicted.rotation)
+			fields |= RotationField;
+		if (current.hitpoints != predicted.hitpoints)
+			fields |= HitpointsField;
+		return fields;
+	}
+}
+
+std::int32_t quantizePosition(float value)
+{
+	return static_cast<std::int32_t>(std::lround(value * PositionScale));
+}
+
+float dequantizePosition(std::int32_t value)
+{
+	return static_cast<float>(value) / PositionScale;
+}
+
+std::uint8_t quantizeRotation(float degrees)
+{
+	float turns = degrees / 360.f;
+	turns -= std::floor(turns);
+	return static_cast<std::uint8_t>(static_cast<int>(std::lround(turns * 256.f)) & 0xff);
+}
+
+float dequantizeRotation(std::uint8_t value)
+{
+	return value * (360.f / 256.f);
+}
+
+void encodeState(const NetworkState& current, const NetworkState* baseline, std::vector<char>& output, NetworkState& sent)
+{
+	BitWriter writer(output);
+	writer.write(current.tick, 32);
+	writer.writeSigned(current.viewY);
+
+	sent.tick = current.tick;
+	sent.viewY = current.viewY;
+	sent.entities.clear();
+
+	const std::uint32_t ticks = baseline ? current.tick - baseline->tick : 0;
+	std::vector<const NetworkEntity*> created;
+
+	// Both lists are sorted by id, walk them together
+	auto itr = current.entities.begin();
+	if (baseline)
+	{
+		for (const NetworkEntity& old : baseline->entities)
+		{
+			while (itr != current.entities.end() && itr->id < old.id)
+				created.push_back(&*itr++);
+
+			bool alive = itr != current.entities.end() && itr->id == old.id;
+			writer.write(alive, 1);
+			if (!alive)
+				continue;
+
+			NetworkEntity predicted = extrapolate(old, ticks);
+			unsigned int fields = changedFields(*itr, predicted);
+			writer.write(fields != 0, 1);
+			if (fields != 0)
+			{
+				writer.write(fields, FieldCount);
+				if (fields & PositionField)
+				{
+					writer.writeSigned(itr->x - predicted.x);
+					writer.writeSigned(itr->y - predicted.y);
+					predicted.x = itr->x;
+					predicted.y = itr->y;
+				}
+				if (fields & VelocityField)
+				{
+					writer.writeSigned(itr->vx - predicted.vx);
+					writer.writeSigned(itr->vy - predicted.vy);
+					predicted.vx = itr->vx;
+					predicted.vy = itr->vy;
+				}
+				if (fields & RotationField)
+				{
+					writer.write(itr->rotation, 8);
+					predicted.rotation = itr->rotation;
+				}
+				if (fields & HitpointsField)
+				{
+					writer.writeSigned(itr->hitpoints - predicted.hitpoints);
+					predicted.hitpoints = itr->hitpoints;
+				}
+			}
+			sent.entities.push_back(predicted);
+			++itr;
+		}
+	}
+	while (itr != current.entities.end())
+		created.push_back(&*itr++);
+
+	writer.writeUnsigned(static_cast<std::uint32_t>(created.size()));
+	std::uint32_t previousId = 0;
+	for (const NetworkEntity* entity : created)
+	{
+		writer.writeUnsigned(entity->id - previousId);
+		writer.write(entity->kind, 2);
+		writer.write(entity->type, 3);
+		writer.write(entity->owner, 2);
+		writer.write(entity->rotation, 8);
+		writer.writeSigned(entity->x);
+		writer.writeSigned(entity->y);
+		writer.writeSigned(entity->vx);
+		writer.writeSigned(entity->vy);
+		writer.writeSigned(entity->hitpoints);
+		previousId = entity->id;
+		sent.entities.push_back(*entity);
+	}
+
+	// Created entities were appended after the updated ones
+	std::inplace_merge(sent.entities.begin(), sent.entities.end() - created.size(), sent.entities.end(),
+		[](const NetworkEntity& lhs, const NetworkEntity& rhs) { return lhs.id < rhs.id; });
+}
+
+bool decodeState(const char* data, std::size_t size, const NetworkState* baseline, NetworkState& output)
+{
+	BitReader reader(data, size);
+	output.tick = reader.read(32);
+	output.viewY = reader.readSigned();
+	output.entities.clear();
+
+	const std::uint32_t ticks = baseline ? output.tick - baseline->tick : 0;
+	if (baseline)
+	{
+		for (const NetworkEntity& old : baseline->entities)
+		{
+			if (!reader.read(1))
+				continue;
+
+			NetworkEntity entity = extrapolate(old, ticks);
+			if (reader.read(1))
+			{
+				unsigned int fields = reader.read(FieldCount);
+				if (fields & PositionField)
+				{
+					entity.x += reader.readSigned();
+					entity.y += reader.readSigned();
+				}
+				if (fields & VelocityField)
+				{
+					entity.vx += reader.readSigned();
+					entity.vy += reader.readSigned();
+				}
+				if (fields & RotationField)
+					entity.rotation = static_cast<std::uint8_t>(reader.read(8));
+				if (fields & HitpointsField)
+					entity.hitpoints += reader.readSigned();
+			}
+			output.entities.push_back(entity);
+		}
+	}
+
+	std::size_t updated = output.entities.size();
+	std::uint32_t count = reader.readUnsigned();
+	if (reader.hasFailed() || count > size * 8)
+		return false;
+
+	std::uint32_t previousId = 0;
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		NetworkEntity entity;
+		entity.id = previousId + reader.readUnsigned();
+		entity.kind = static_cast<std::uint8_t>(reader.read(2));
+		entity.type = static_cast<std::uint8_t>(reader.read(3));
+		entity.owner = static_cast<std::uint8_t>(reader.read(2));
+		entity.rotation = static_cast<std::uint8_t>(reader.read(8));
+		entity.x = reader.readSigned();
+		entity.y = reader.readSigned();
+		entity.vx = reader.readSigned();
+		entity.vy = reader.readSigned();
+		entity.hitpoints = reader.readSigned();
+		previousId = entity.id;
+		output.entities.push_back(entity);
+	}
+
+	std::inplace_merge(output.entities.begin(), output.entities.begin() + updated, output.entities.end(),
+		[](const NetworkEntity& lhs, const NetworkEntity& rhs) { return lhs.id < rhs.id; });
+	return !reader.hasFailed();
+}
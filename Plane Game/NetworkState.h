@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Quantized view of the entities a co-op host sends to its client.
+// Positions and velocities are fixed point in 1/PositionScale units,
+// rotations a byte per turn.
+struct NetworkEntity
+{
+	enum Kind : std::uint8_t
+	{
+		Aircraft,
+		Projectile,
+		Pickup,
+	};
+
+	std::uint32_t					id;
+	std::uint8_t					kind;
+	std::uint8_t					type;
+	// Player identifier for player aircraft
+	std::uint8_t					owner;
+	std::uint8_t					rotation;
+	std::int32_t					x;
+	std::int32_t					y;
+	std::int32_t					vx;
+	std::int32_t					vy;
+	std::int32_t					hitpoints;
+};
+
+struct NetworkState
+{
+	std::uint32_t					tick;
+	std::int32_t					viewY;
+	// Sorted by id
+	std::vector<NetworkEntity>		entities;
+};
+
+const int							PositionScale = 8;
+const int							NetworkTicksPerSecond = 60;
+
+std::int32_t						quantizePosition(float value);
+float								dequantizePosition(std::int32_t value);
+std::uint8_t						quantizeRotation(float degrees);
+float								dequantizeRotation(std::uint8_t value);
+
+// Encodes current against baseline (nullptr for a full state). An entity
+// whose fields match the baseline moved along its velocity costs two bits.
+// sent receives the state exactly as the receiver will decode it, which is
+// what later deltas must be based on.
+void								encodeState(const NetworkState& current, const NetworkState* baseline,
+										std::vector<char>& output, NetworkState& sent);
+// False on malformed input
+bool								decodeState(const char* data, std::size_t size, const NetworkState* baseline,
+										NetworkState& output);
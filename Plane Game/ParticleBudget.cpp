@@ -0,0 +1,135 @@
+#include "ParticleBudget.h"
+#include "DataTables.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace
+{
+	const ParticleTable TABLE = initializeParticleData();
+
+	// Emission never drops below this fraction of the table rate
+	const float MinRateScale = 0.2f;
+	const float ThrottleFactor = 0.9f;
+	const float RecoverStep = 0.05f;
+
+	// Share of the cap kept free for each priority level above a type
+	const float ReservePerLevel = 0.1f;
+}
+
+ParticleBudget::ParticleBudget(Profiler& profiler, std::size_t globalCap)
+	: profiler(profiler)
+	, globalCap(globalCap)
+	, liveCount(0)
+	, targetFrameTime(sf::seconds(1.f / 60.f))
+	, priorities()
+	, rateScales()
+	, liveCounts()
+{
+	priorities.fill(0);
+	rateScales.fill(1.f);
+	liveCounts.fill(0);
+
+	// Missile flames read better than smoke, so smoke degrades first
+	setPriority(Particle::Type::Propellant, 1);
+	setPriority(Particle::Type::Smoke, 0);
+}
+
+void ParticleBudget::setGlobalCap(std::size_t cap)
+{
+	globalCap = cap;
+}
+
+void ParticleBudget::setPriority(Particle::Type type, int priority)
+{
+	priorities[static_cast<std::size_t>(type)] = priority;
+}
+
+void ParticleBudget::setTargetFrameTime(sf::Time time)
+{
+	targetFrameTime = time;
+}
+
+void ParticleBudget::update(sf::Time frameTime)
+{
+	if (frameTime > targetFrameTime * 1.1f)
+		throttle();
+	else if (frameTime < targetFrameTime * 0.9f)
+		recover();
+
+	float lowestScale = *std::min_element(rateScales.begin(), rateScales.end());
+	profiler.setValue("Particles", static_cast<float>(liveCount));
+	profiler.setValue("Particle rate %", lowestScale * 100.f);
+}
+
+float ParticleBudget::getEmissionRate(Particle::Type type) const
+{
+	return TABLE[type].emissionRate * rateScales[static_cast<std::size_t>(type)];
+}
+
+bool ParticleBudget::acquire(Particle::Type type)
+{
+	if (liveCount >= getLimit(type))
+	{
+		profiler.addCount("Particle budget hits");
+		return false;
+	}
+
+	liveCount += 1;
+	liveCounts[static_cast<std::size_t>(type)] += 1;
+	return true;
+}
+
+void ParticleBudget::release(Particle::Type type, std::size_t count)
+{
+	std::size_t& typeCount = liveCounts[static_cast<std::size_t>(type)];
+	assert(typeCount >= count);
+
+	typeCount -= count;
+	liveCount -= count;
+}
+
+void ParticleBudget::throttle()
+{
+	// Slow down the least important types that still have room to degrade
+	int lowest = std::numeric_limits<int>::max();
+	for (std::size_t i = 0; i < TypeCount; ++i)
+	{
+		if (rateScales[i] > MinRateScale)
+			lowest = std::min(lowest, priorities[i]);
+	}
+
+	for (std::size_t i = 0; i < TypeCount; ++i)
+	{
+		if (priorities[i] == lowest)
+			rateScales[i] = std::max(rateScales[i] * ThrottleFactor, MinRateScale);
+	}
+}
+
+void ParticleBudget::recover()
+{
+	// Restore the most important types first
+	int highest = std::numeric_limits<int>::min();
+	for (std::size_t i = 0; i < TypeCount; ++i)
+	{
+		if (rateScales[i] < 1.f)
+			highest = std::max(highest, priorities[i]);
+	}
+
+	for (std::size_t i = 0; i < TypeCount; ++i)
+	{
+		if (priorities[i] == highest)
+			rateScales[i] = std::min(rateScales[i] + RecoverStep, 1.f);
+	}
+}
+
+std::size_t ParticleBudget::getLimit(Particle::Type type) const
+{
+	int highest = *std::max_element(priorities.begin(), priorities.end());
+	int levelsBelow = highest - priorities[static_cast<std::size_t>(type)];
+
+	float share = std::max(1.f - ReservePerLevel * levelsBelow, 0.f);
+	return static_cast<std::size_t>(globalCap * share);
+}
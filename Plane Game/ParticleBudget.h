@@ -0,0 +1,47 @@
+#pragma once
+#include "Particle.h"
+
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+
+class Profiler;
+
+// Shares one particle allowance between all particle systems and throttles
+// emission, lowest priority first, when frames run long
+class ParticleBudget : private sf::NonCopyable
+{
+public:
+	// The default cap is below the 10240 particles the smoke and propellant
+	// rings hold together, so the cap and the priority reserve actually bind
+	explicit				ParticleBudget(Profiler& profiler, std::size_t globalCap = 8000);
+
+	void					setGlobalCap(std::size_t cap);
+	void					setPriority(Particle::Type type, int priority);
+	void					setTargetFrameTime(sf::Time time);
+
+	// Once per rendered frame, with that frame's time
+	void					update(sf::Time frameTime);
+
+	float					getEmissionRate(Particle::Type type) const;
+	bool					acquire(Particle::Type type);
+	void					release(Particle::Type type, std::size_t count);
+
+private:
+	void					throttle();
+	void					recover();
+	std::size_t				getLimit(Particle::Type type) const;
+
+private:
+	static const std::size_t TypeCount = static_cast<std::size_t>(Particle::Type::particleCount);
+
+	Profiler&							profiler;
+	std::size_t							globalCap;
+	std::size_t							liveCount;
+	sf::Time							targetFrameTime;
+
+	std::array<int, TypeCount>			priorities;
+	std::array<float, TypeCount>		rateScales;
+	std::array<std::size_t, TypeCount>	liveCounts;
+};
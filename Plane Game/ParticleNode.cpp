@@ -1,6 +1,9 @@
 #include "ParticleNode.h"
 #include "Particle.h"
 #include "DataTables.h"
+#include "ThreadPool.h"
+#include "ParticleBudget.h"
+#include "SceneRegistry.h"
 
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Texture.hpp>
@@ -9,30 +12,64 @@
 
 namespace
 {
-	const std::map<Particle::Type, ParticleData> TABLE = initializeParticleData();
+	const ParticleTable TABLE = initializeParticleData();
+
+	// Particles handed to one worker task
+	const std::size_t ChunkSize = 1024;
 }
 
 
-ParticleNode::ParticleNode(Particle::Type type, const TextureHolder_t& textures)
+ParticleNode::ParticleNode(Particle::Type type, const TextureHolder_t& textures, ParticleBudget& budget)
 	: SceneNode()
-	, particles()
+	, positions(TABLE[type].capacity)
+	, birthTimes(TABLE[type].capacity)
+	, colors(TABLE[type].capacity)
+	, first(0)
+	, count(0)
+	, elapsedTime(0.f)
 	, texture(textures.get(TextureID::Particle))
 	, type(type)
-	, vertexArray(sf::Quads)
-	, needsVertexUpdate(true)
+	, budget(budget)
+	, color(TABLE[type].color)
+	, lifetime(TABLE[type].lifetime.asSeconds())
+	, capacity(TABLE[type].capacity)
+	, vertexBuffers()
+	, frontBuffer(0)
+	, frontCount(0)
+	, backCount(0)
+	, pendingJobs()
+	, hasPendingVertices(false)
 {
+	vertexBuffers[0].resize(capacity * 4);
+	vertexBuffers[1].resize(capacity * 4);
+}
 
+ParticleNode::~ParticleNode()
+{
+	// Workers still reference our arrays
+	finishVertices();
+	budget.release(type, count);
 }
 
 void ParticleNode::addParticle(sf::Vector2f position)
 {
+	// Buffer full, the oldest particle makes room for the new one
+	if (count == capacity)
+	{
+		first = (first + 1) % capacity;
+		count -= 1;
+	}
+	else if (!budget.acquire(type))
+	{
+		return;
+	}
 
-	Particle particle;
-	particle.position = position;
-	particle.color = TABLE.at(type).color;
-	particle.lifetime = TABLE.at(type).lifetime;
+	std::size_t slot = (first + count) % capacity;
+	positions[slot] = position;
+	birthTimes[slot] = elapsedTime;
+	colors[slot] = color;
 
-	particles.push_back(particle);
+	count += 1;
 }
 
 Particle::Type ParticleNode::getParticleType() const
@@ -40,67 +77,99 @@ Particle::Type ParticleNode::getParticleType() const
 	return type;
 }
 
-unsigned int ParticleNode::getCategory() const
+float ParticleNode::getEmissionRate() const
 {
-	return Category::ParticleSystem;
+	return budget.getEmissionRate(type);
 }
 
-void ParticleNode::updateCurrent(sf::Time dt, CommandQueue& commands)
+void ParticleNode::prepareVertices(ThreadPool& workers)
 {
-	while (!particles.empty() && particles.front().lifetime <= sf::Time::Zero)
-		particles.pop_front();
+	finishVertices();
 
+	backCount = count;
+	hasPendingVertices = true;
+	std::vector<sf::Vertex>& output = vertexBuffers[1 - frontBuffer];
 
-	for (auto& particle : particles)
-		particle.lifetime -= dt;
-
-	needsVertexUpdate = true;
+	for (std::size_t begin = 0; begin < backCount; begin += ChunkSize)
+	{
+		std::size_t end = std::min(begin + ChunkSize, backCount);
+		pendingJobs.push_back(workers.enqueue([this, begin, end, &output]()
+		{
+			computeVertices(begin, end, output);
+		}));
+	}
 }
 
-void ParticleNode::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
+void ParticleNode::finishVertices()
 {
-	if (needsVertexUpdate) {
+	if (!hasPendingVertices)
+		return;
 
-		computeVertices();
-		needsVertexUpdate = false;
-	}
+	for (auto& job : pendingJobs)
+		job.get();
+	pendingJobs.clear();
 
-	states.texture = &texture;
+	frontBuffer = 1 - frontBuffer;
+	frontCount = backCount;
+	hasPendingVertices = false;
+}
 
-	target.draw(vertexArray, states);
+unsigned int ParticleNode::getCategory() const
+{
+	return Category::ParticleSystem;
+}
 
+void ParticleNode::onAttach(SceneRegistry& registry)
+{
+	registry.registerParticleSystem(*this);
 }
 
-void ParticleNode::addVertex(float worldX, float worldY, float texCoordX, float texCoordY, const sf::Color& color) const
+void ParticleNode::updateCurrent(sf::Time dt, CommandQueue& commands)
 {
+	elapsedTime += dt.asSeconds();
 
-	sf::Vertex vertex;
-	vertex.position = sf::Vector2f(worldX, worldY);
-	vertex.texCoords = sf::Vector2f(texCoordX, texCoordY);
-	vertex.color = color;
+	// All particles share one lifetime, so the oldest always expire first
+	std::size_t expired = 0;
+	while (expired < count && elapsedTime - birthTimes[(first + expired) % capacity] >= lifetime)
+		expired += 1;
 
+	first = (first + expired) % capacity;
+	count -= expired;
+	budget.release(type, expired);
 
-	vertexArray.append(vertex);
+	// Restart the clock when idle to keep float precision
+	if (count == 0)
+		elapsedTime = 0.f;
 }
 
-void ParticleNode::computeVertices() const
+void ParticleNode::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	if (frontCount == 0)
+		return;
+
+	states.texture = &texture;
+	target.draw(vertexBuffers[frontBuffer].data(), frontCount * 4, sf::Quads, states);
+}
+
+void ParticleNode::computeVertices(std::size_t begin, std::size_t end, std::vector<sf::Vertex>& output) const
 {
 	sf::Vector2f size(texture.getSize());
 	sf::Vector2f half = size / 2.f;
+	const float invLifetime = 1.f / lifetime;
 
-	// Refill vertex array
-	vertexArray.clear();
-	for (const auto& particle : particles)
+	// Output is compacted in age order, so the ring wrap disappears here
+	for (std::size_t i = begin; i < end; ++i)
 	{
-		sf::Vector2f pos = particle.position;
-		sf::Color color = particle.color;
-		float ratio = particle.lifetime.asSeconds() / TABLE.at(type).lifetime.asSeconds();
-		color.a = static_cast<sf::Uint8>(255 * std::max(ratio, 0.f));
-		addVertex(pos.x - half.x, pos.y - half.y, 0.f, 0.f, color);
-		addVertex(pos.x + half.x, pos.y - half.y, size.x, 0.f, color);
-		addVertex(pos.x + half.x, pos.y + half.y, size.x, size.y, color);
-		addVertex(pos.x - half.x, pos.y + half.y, 0.f, size.y, color);
+		std::size_t slot = (first + i) % capacity;
+		sf::Vector2f pos = positions[slot];
+		sf::Color quadColor = colors[slot];
+		float ratio = 1.f - (elapsedTime - birthTimes[slot]) * invLifetime;
+		quadColor.a = static_cast<sf::Uint8>(255.f * std::max(ratio, 0.f));
+
+		sf::Vertex* quad = &output[i * 4];
+		quad[0] = sf::Vertex(sf::Vector2f(pos.x - half.x, pos.y - half.y), quadColor, sf::Vector2f(0.f, 0.f));
+		quad[1] = sf::Vertex(sf::Vector2f(pos.x + half.x, pos.y - half.y), quadColor, sf::Vector2f(size.x, 0.f));
+		quad[2] = sf::Vertex(sf::Vector2f(pos.x + half.x, pos.y + half.y), quadColor, sf::Vector2f(size.x, size.y));
+		quad[3] = sf::Vertex(sf::Vector2f(pos.x - half.x, pos.y + half.y), quadColor, sf::Vector2f(0.f, size.y));
 	}
 }
-
-
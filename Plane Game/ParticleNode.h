@@ -1,35 +1,61 @@
 #pragma once
 #include "SceneNode.h"
-#include "SceneNode.h"
 #include "ResourceIdentifier.h"
 #include "Particle.h"
-#include <SFML/Graphics/VertexArray.hpp>
-#include <deque>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/Color.hpp>
+#include <array>
+#include <future>
+#include <vector>
+
+class ThreadPool;
+class ParticleBudget;
 
 class ParticleNode : public SceneNode
 {
 public:
-							ParticleNode(Particle::Type type, const TextureHolder_t& textures);
+							ParticleNode(Particle::Type type, const TextureHolder_t& textures, ParticleBudget& budget);
+							~ParticleNode();
+
 	void					addParticle(sf::Vector2f position);
 	Particle::Type			getParticleType() const;
+	float					getEmissionRate() const;
+
+	void					prepareVertices(ThreadPool& workers);
+	void					finishVertices();
 
 	virtual unsigned int	getCategory() const override;
 
 private:
-	
+	virtual void			onAttach(SceneRegistry& registry) override;
 	virtual void			updateCurrent(sf::Time dt, CommandQueue& commands);
 	virtual void			drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const;
-	
-	void					addVertex(float worldX, float worldY, float texCoordX, float texCoordY, const sf::Color& color) const;
-	void					computeVertices() const;
+
+	void					computeVertices(std::size_t begin, std::size_t end, std::vector<sf::Vertex>& output) const;
 
 private:
+	// Fixed capacity ring buffer, one slot per particle (structure of arrays)
+	std::vector<sf::Vector2f>						positions;
+	std::vector<float>								birthTimes;
+	std::vector<sf::Color>							colors;
+	std::size_t										first;
+	std::size_t										count;
+	float											elapsedTime;
 
-	std::deque<Particle>	particles;
+	const sf::Texture&								texture;
+	Particle::Type									type;
+	ParticleBudget&									budget;
 
-	const sf::Texture&		texture;
-	Particle::Type			type;
+	// Per type constants, looked up once
+	const sf::Color									color;
+	const float										lifetime;
+	const std::size_t								capacity;
 
-	mutable sf::VertexArray	vertexArray;
-	mutable bool			needsVertexUpdate;
-};
\ No newline at end of file
+	// Workers fill the back buffer while the front buffer is drawn
+	std::array<std::vector<sf::Vertex>, 2>			vertexBuffers;
+	std::size_t										frontBuffer;
+	std::size_t										frontCount;
+	std::size_t										backCount;
+	std::vector<std::future<void>>					pendingJobs;
+	bool											hasPendingVertices;
+};
@@ -1,6 +1,7 @@
 #include "PauseState.h"
 #include "Utility.h"
 #include "ResourceHolder.h"
+#include "MusicPlayer.h"
 #include <SFML/Graphics/RectangleShape.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Graphics/View.hpp>
@@ -21,6 +22,13 @@ PauseState::PauseState(StateStack& stack, Context context)
 	instructionText.setString("(Press Backspace to return to the main menu)");
 	centerOrigin(instructionText);
 	instructionText.setPosition(0.5f * viewSize.x, 0.6f * viewSize.y);
+
+	getContext().music->setPaused(true);
+}
+
+PauseState::~PauseState()
+{
+	getContext().music->setPaused(false);
 }
 void PauseState::draw()
 {
@@ -9,6 +9,7 @@ class PauseState : public State
 
 public:
 							PauseState(StateStack& stack, Context context);
+							~PauseState();
 
 	virtual void			draw() override;
 	virtual bool			update(sf::Time dt) override;
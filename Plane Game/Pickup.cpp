@@ -1,17 +1,18 @@
 #include "Pickup.h"
 #include "DataTables.h"
 #include "Utility.h"
+#include "WorldSnapshot.h"
 #include "SFML/Graphics/RenderTarget.hpp"
 #include "SFML/Graphics/RenderStates.hpp"
 
 namespace {
-	const std::map<Pickup::Type,PickupData> TABLE = initializePickupData();
+	const PickupTable TABLE = initializePickupData();
 }
 
 Pickup::Pickup(Type type, const TextureHolder_t& textures)
 	: Entity(1)
 	, type(type)
-	, sprite(textures.get(TABLE.at(type).texture),TABLE.at(type).textureRect)
+	, sprite(textures.get(TABLE[type].texture),TABLE[type].textureRect)
 {
 	centerOrigin(sprite);
 }
@@ -28,7 +29,31 @@ sf::FloatRect Pickup::getBoundingRect() const
 
 void Pickup::apply(Aircraft& player) const
 {
-	TABLE.at(type).action(player);
+	TABLE[type].action(player);
+}
+
+Pickup::Type Pickup::getType() const
+{
+	return type;
+}
+
+PickupState Pickup::saveState() const
+{
+	PickupState state;
+	state.type = static_cast<std::int32_t>(type);
+	state.hitpoints = getHitpoints();
+	state.x = getPosition().x;
+	state.y = getPosition().y;
+	state.vx = getVelocity().x;
+	state.vy = getVelocity().y;
+	return state;
+}
+
+void Pickup::loadState(const PickupState& state)
+{
+	setHitpoints(state.hitpoints);
+	setPosition(state.x, state.y);
+	setVelocity(state.vx, state.vy);
 }
 
 void Pickup::drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const
@@ -1,6 +1,8 @@
 #pragma once
 #include "Aircraft.h"
 #include "Entity.h"
+
+struct PickupState;
 class Pickup : public Entity
 {
 public:
@@ -20,6 +22,10 @@ public:
     virtual sf::FloatRect  getBoundingRect() const;
 
     void                   apply(Aircraft& player) const;
+    Type                   getType() const;
+
+    PickupState            saveState() const;
+    void                   loadState(const PickupState& state);
 
 protected:
     virtual void           drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const;
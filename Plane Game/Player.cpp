@@ -2,9 +2,20 @@
 #include "Aircraft.h"
 #include <algorithm>
 #include "CommandQueue.h"
+#include "Random.h"
 
-Player::Player()
+namespace
+{
+	const std::string LastReplayFile = "LastGame.rpl";
+}
+
+static_assert(static_cast<int>(Player::Action::ActionCount) <= 8, "Actions no longer fit in Replay::ActionMask");
+
+Player::Player(int identifier)
 	: currentMissionStatus(MissionStatus::Running)
+	, identifier(identifier)
+	, pendingActions(0)
+	, replay()
 {
 	
 	initializeKeyBindings();
@@ -27,21 +38,77 @@ void Player::handleEvent(const sf::Event& event, CommandQueue& commands)
 	if (event.type == sf::Event::KeyPressed)
 	{
 		// Check if pressed key appears in key binding, trigger command if so
+		// Recorded now, pushed with the next tick so replays see the same order
 		auto found = keyBindings.find(event.key.code);
 		if (found != keyBindings.end() && !isRealTimeAction(found->second))
-			commands.push(actionBindings[found->second]);
+			pendingActions |= toMask(found->second);
 	}
 }
 
 void Player::handleRealTimeInput(CommandQueue& commands)
 {
-	for (auto pair : keyBindings) {
-		if (sf::Keyboard::isKeyPressed(pair.first) && isRealTimeAction(pair.second)) {
-			commands.push(actionBindings[pair.second]);
+	pushActions(collectActions(), commands);
+}
+
+Replay::ActionMask Player::collectActions()
+{
+	Replay::ActionMask actions = pendingActions;
+	pendingActions = 0;
+
+	if (replay.isPlaying())
+	{
+		if (!replay.next(actions))
+			actions = 0;
+	}
+	else
+	{
+		for (auto pair : keyBindings) {
+			if (sf::Keyboard::isKeyPressed(pair.first) && isRealTimeAction(pair.second)) {
+				actions |= toMask(pair.second);
+			}
 		}
+		replay.record(actions);
+	}
+	return actions;
+}
+
+void Player::pushActions(Replay::ActionMask actions, CommandQueue& commands)
+{
+	for (auto& pair : actionBindings)
+		if (actions & toMask(pair.first))
+			commands.push(pair.second);
+}
+
+void Player::beginMission()
+{
+	pendingActions = 0;
+	if (replay.isPlaying())
+	{
+		replay.startPlayback();
+		seedRandom(replay.getSeed());
+	}
+	else
+	{
+		std::uint64_t seed = generateSeed();
+		seedRandom(seed);
+		replay.startRecording(seed);
+	}
+}
+
+void Player::endMission()
+{
+	if (replay.isRecording())
+	{
+		replay.stopRecording();
+		replay.saveToFile(LastReplayFile);
 	}
 }
 
+Replay& Player::getReplay()
+{
+	return replay;
+}
+
 void Player::setMissionStatus(MissionStatus status)
 {
 	currentMissionStatus = status;
@@ -84,8 +151,33 @@ void Player::initializeActions()
 		});
 
 	for (auto& pair : actionBindings)
-			pair.second.category = Category::PlayerAircraft;
-		
+	{
+		pair.second.category = Category::PlayerAircraft;
+
+		// In co-op both players fly an Eagle
+		auto action = pair.second.action;
+		int owner = identifier;
+		pair.second.action = derivedAction<Aircraft>([action, owner](Aircraft& a, sf::Time dt) {
+			if (a.getIdentifier() == owner)
+				action(a, dt);
+		});
+	}
+}
+
+Replay::ActionMask Player::getRealTimeMask()
+{
+	Replay::ActionMask mask = 0;
+	for (int i = 0; i < static_cast<int>(Action::ActionCount); ++i)
+	{
+		if (isRealTimeAction(static_cast<Action>(i)))
+			mask |= toMask(static_cast<Action>(i));
+	}
+	return mask;
+}
+
+Replay::ActionMask Player::toMask(Action action)
+{
+	return static_cast<Replay::ActionMask>(1u << static_cast<unsigned int>(action));
 }
 
 bool Player::isRealTimeAction(Action action)
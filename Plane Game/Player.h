@@ -3,6 +3,7 @@
 #include <SFML/Window/Event.hpp>
 
 #include"Command.h"
+#include "Replay.h"
 #include <map>
 
 //forward decleration
@@ -29,10 +30,23 @@ public:
 	};
 
 public:
-											Player();
+	// Commands only reach the aircraft with the same identifier
+	explicit								Player(int identifier = 0);
 	void									initializeKeyBindings();
 	void									handleEvent(const sf::Event& event, CommandQueue& commands);
+	// Once per tick: merges the events since the last tick with the held keys,
+	// or takes the tick from the replay being played
 	void									handleRealTimeInput(CommandQueue& commands);
+	Replay::ActionMask						collectActions();
+	// Also used by a co-op host for the actions its client sent
+	void									pushActions(Replay::ActionMask actions, CommandQueue& commands);
+	// Actions that last while their key is held, the rest fire once per press
+	static Replay::ActionMask				getRealTimeMask();
+
+	// Seeds the RNG and starts recording, or rewinds the loaded replay
+	void									beginMission();
+	void									endMission();
+	Replay&									getReplay();
 
 	void									setMissionStatus(MissionStatus status);
 	MissionStatus							getMissionStatus() const;
@@ -40,13 +54,17 @@ public:
 private:
 	void									initializeActions();
 	static bool								isRealTimeAction(Action action);
+	static Replay::ActionMask				toMask(Action action);
 
 	MissionStatus							currentMissionStatus;
+	int										identifier;
 
 
 private:
 	std::map<sf::Keyboard::Key, Action>		keyBindings;
 	std::map<Action, Command>				actionBindings;
+	Replay::ActionMask						pendingActions;
+	Replay									replay;
 
 };
 
@@ -3,28 +3,44 @@
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/VertexArray.hpp>
 
+namespace
+{
+	// Unit quad shared by every pass, scaled to the output when drawn
+	sf::VertexArray createFullscreenQuad()
+	{
+		sf::VertexArray vertices(sf::TrianglesStrip, 4);
+		vertices[0] = sf::Vertex(sf::Vector2f(0, 0), sf::Vector2f(0, 1));
+		vertices[1] = sf::Vertex(sf::Vector2f(1, 0), sf::Vector2f(1, 1));
+		vertices[2] = sf::Vertex(sf::Vector2f(0, 1), sf::Vector2f(0, 0));
+		vertices[3] = sf::Vertex(sf::Vector2f(1, 1), sf::Vector2f(1, 0));
+		return vertices;
+	}
+
+	const sf::VertexArray FullscreenQuad = createFullscreenQuad();
+}
+
 PostEffect::~PostEffect()
 {
 }
 
+bool PostEffect::isEnabled() const
+{
+	return true;
+}
+
 void PostEffect::applyShader(const sf::Shader& shader, sf::RenderTarget& output)
 {
 	sf::Vector2f outputSize = static_cast<sf::Vector2f>(output.getSize());
 
-	sf::VertexArray vertices(sf::TrianglesStrip, 4);
-	vertices[0] = sf::Vertex(sf::Vector2f(0, 0), sf::Vector2f(0, 1));
-	vertices[1] = sf::Vertex(sf::Vector2f(outputSize.x, 0), sf::Vector2f(1, 1));
-	vertices[2] = sf::Vertex(sf::Vector2f(0, outputSize.y), sf::Vector2f(0, 0));
-	vertices[3] = sf::Vertex(sf::Vector2f(outputSize), sf::Vector2f(1, 0));
-
 	sf::RenderStates states;
 	states.shader = &shader;
 	states.blendMode = sf::BlendNone;
+	states.transform.scale(outputSize.x, outputSize.y);
 
-	output.draw(vertices, states);
+	output.draw(FullscreenQuad, states);
 }
 
 bool PostEffect::isSupported()
 {
 	return sf::Shader::isAvailable();
-}
\ No newline at end of file
+}
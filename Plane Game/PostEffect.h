@@ -1,18 +1,23 @@
 #include <SFML/System/NonCopyable.hpp>
 #pragma once
 
+#include <string>
+
 namespace sf
 {
 	class RenderTarget;
 	class RenderTexture;
 	class Shader;
 }
+class RenderTexturePool;
 
 class PostEffect : sf::NonCopyable
 {
 public:
 	virtual					~PostEffect();
-	virtual void			apply(const sf::RenderTexture& input, sf::RenderTarget& output) = 0;
+	virtual void			apply(const sf::RenderTexture& input, sf::RenderTarget& output, RenderTexturePool& pool) = 0;
+	virtual bool			isEnabled() const;
+	virtual std::string		getName() const = 0;
 	
 	static bool				isSupported();
 
@@ -20,4 +25,3 @@ protected:
 	static void				applyShader(const sf::Shader& shader, sf::RenderTarget& output);
 
 };
-
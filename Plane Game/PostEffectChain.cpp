@@ -0,0 +1,65 @@
+#include "PostEffectChain.h"
+#include "PostEffect.h"
+#include "RenderTexturePool.h"
+#include "Profiler.h"
+
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/System/Clock.hpp>
+
+PostEffectChain::PostEffectChain(RenderTexturePool& pool, Profiler& profiler)
+	: effects()
+	, pool(pool)
+	, profiler(profiler)
+{
+}
+
+void PostEffectChain::addEffect(PostEffect& effect)
+{
+	effects.push_back(&effect);
+}
+
+bool PostEffectChain::isActive() const
+{
+	for (const PostEffect* effect : effects)
+	{
+		if (effect->isEnabled())
+			return true;
+	}
+	return false;
+}
+
+void PostEffectChain::apply(const sf::RenderTexture& input, sf::RenderTarget& output)
+{
+	std::vector<PostEffect*> enabled;
+	for (PostEffect* effect : effects)
+	{
+		if (effect->isEnabled())
+			enabled.push_back(effect);
+	}
+
+	const sf::RenderTexture* source = &input;
+	sf::RenderTexture* intermediate = nullptr;
+
+	for (std::size_t i = 0; i < enabled.size(); ++i)
+	{
+		// The last effect writes straight to the output
+		bool isLast = (i + 1 == enabled.size());
+		sf::RenderTexture* destination = isLast ? nullptr : &pool.acquire(input.getSize());
+
+		// CPU side cost only, the GPU work itself is queued asynchronously
+		sf::Clock clock;
+		if (isLast)
+			enabled[i]->apply(*source, output, pool);
+		else
+		{
+			enabled[i]->apply(*source, *destination, pool);
+			destination->display();
+		}
+		profiler.addSample(enabled[i]->getName(), clock.getElapsedTime());
+
+		if (intermediate)
+			pool.release(*intermediate);
+		intermediate = destination;
+		source = destination;
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+
+#include <vector>
+
+namespace sf
+{
+	class RenderTarget;
+	class RenderTexture;
+}
+class PostEffect;
+class RenderTexturePool;
+class Profiler;
+
+// Runs post effects in order, each reading the previous effect's output.
+// Intermediates between effects come from the shared pool. The chain sees
+// whole effects only; each effect wires its own passes, taking their
+// targets from the same pool.
+class PostEffectChain : private sf::NonCopyable
+{
+public:
+							PostEffectChain(RenderTexturePool& pool, Profiler& profiler);
+
+	void					addEffect(PostEffect& effect);
+	bool					isActive() const;
+
+	void					apply(const sf::RenderTexture& input, sf::RenderTarget& output);
+
+private:
+	std::vector<PostEffect*>	effects;
+	RenderTexturePool&			pool;
+	Profiler&					profiler;
+};
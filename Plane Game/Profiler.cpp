@@ -0,0 +1,82 @@
+#include "Profiler.h"
+
+#include <sstream>
+
+namespace
+{
+	// Weight of the newest frame in the smoothed frame time
+	const float FrameSmoothing = 0.1f;
+}
+
+Profiler::Profiler()
+	: frameTime(sf::seconds(1.f / 60.f))
+	, samples()
+	, counters()
+	, values()
+{
+}
+
+void Profiler::beginFrame(sf::Time time)
+{
+	frameTime = frameTime + (time - frameTime) * FrameSmoothing;
+}
+
+sf::Time Profiler::getFrameTime() const
+{
+	return frameTime;
+}
+
+void Profiler::addSample(const std::string& name, sf::Time time)
+{
+	Sample& sample = samples[name];
+	sample.total += time;
+	sample.calls += 1;
+}
+
+void Profiler::addCount(const std::string& name, std::size_t count)
+{
+	counters[name] += count;
+}
+
+void Profiler::setValue(const std::string& name, float value)
+{
+	values[name] = value;
+}
+
+sf::Time Profiler::getAverage(const std::string& name) const
+{
+	auto found = samples.find(name);
+	if (found == samples.end() || found->second.calls == 0)
+		return sf::Time::Zero;
+	return found->second.total / static_cast<sf::Int64>(found->second.calls);
+}
+
+float Profiler::getValue(const std::string& name) const
+{
+	auto found = values.find(name);
+	return found != values.end() ? found->second : 0.f;
+}
+
+std::string Profiler::flushReport()
+{
+	std::ostringstream report;
+
+	// Timings are averaged per call, counters summed over the interval
+	for (auto& pair : samples)
+	{
+		if (pair.second.calls > 0)
+			report << pair.first << " = " << pair.second.total.asMicroseconds() / static_cast<sf::Int64>(pair.second.calls) << "us\n";
+		pair.second = Sample();
+	}
+
+	for (auto& pair : counters)
+	{
+		report << pair.first << " = " << pair.second << "\n";
+		pair.second = 0;
+	}
+
+	for (const auto& pair : values)
+		report << pair.first << " = " << pair.second << "\n";
+
+	return report.str();
+}
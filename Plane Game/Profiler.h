@@ -0,0 +1,41 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <map>
+#include <string>
+
+// Collects named timings and counters for the statistics overlay
+class Profiler : private sf::NonCopyable
+{
+public:
+									Profiler();
+
+	void							beginFrame(sf::Time frameTime);
+	sf::Time						getFrameTime() const;
+
+	void							addSample(const std::string& name, sf::Time time);
+	void							addCount(const std::string& name, std::size_t count = 1);
+	void							setValue(const std::string& name, float value);
+
+	// Mean per call of the samples since the last report, zero without any
+	sf::Time						getAverage(const std::string& name) const;
+	// Zero when never set
+	float							getValue(const std::string& name) const;
+
+	std::string						flushReport();
+
+private:
+	struct Sample
+	{
+		sf::Time					total;
+		std::size_t					calls;
+	};
+
+private:
+	sf::Time						frameTime;
+
+	std::map<std::string, Sample>		samples;
+	std::map<std::string, std::size_t>	counters;
+	std::map<std::string, float>		values;
+};
@@ -4,15 +4,16 @@
 #include "DataTables.h"
 #include "Utility.h"
 #include "EmitterNode.h"
+#include "WorldSnapshot.h"
 
 namespace
 {
-    const std::map<Projectile::Type,ProjectileData> TABLE = initializeProjectileData();
+    const ProjectileTable& TABLE = entityTables().projectiles;
 }
 Projectile::Projectile(Type type, const TextureHolder_t& textures)
     : Entity(1)
     , type(type)
-    , sprite(textures.get(TABLE.at(type).texture), TABLE.at(type).textureRect)
+    , sprite(textures.get(TABLE[type].texture), TABLE[type].textureRect)
     , targetDirection()
 {
     centerOrigin(sprite);
@@ -50,12 +51,17 @@ unsigned int Projectile::getCategory() const
 
 float Projectile::getMaxSpeed() const
 {
-    return TABLE.at(type).speed;
+    return TABLE[type].speed;
 }
 
 int Projectile::getDamage() const
 {
-    return TABLE.at(type).damage;
+    return TABLE[type].damage;
+}
+
+Projectile::Type Projectile::getType() const
+{
+    return type;
 }
 
 sf::FloatRect Projectile::getBoundingRect() const
@@ -68,6 +74,30 @@ void Projectile::drawCurrent(sf::RenderTarget& target, sf::RenderStates states)
     target.draw(sprite, states);
 }
 
+ProjectileState Projectile::saveState() const
+{
+    ProjectileState state;
+    state.type = static_cast<std::int32_t>(type);
+    state.hitpoints = getHitpoints();
+    state.x = getPosition().x;
+    state.y = getPosition().y;
+    state.rotation = getRotation();
+    state.vx = getVelocity().x;
+    state.vy = getVelocity().y;
+    state.targetX = targetDirection.x;
+    state.targetY = targetDirection.y;
+    return state;
+}
+
+void Projectile::loadState(const ProjectileState& state)
+{
+    setHitpoints(state.hitpoints);
+    setPosition(state.x, state.y);
+    setRotation(state.rotation);
+    setVelocity(state.vx, state.vy);
+    targetDirection = sf::Vector2f(state.targetX, state.targetY);
+}
+
 void Projectile::updateCurrent(sf::Time dt, CommandQueue& commands)
 {
     if (isGuided())
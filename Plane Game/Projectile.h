@@ -5,6 +5,8 @@
 
 #include <SFML/Graphics/Sprite.hpp>
 
+struct ProjectileState;
+
 class Projectile : public Entity
 {
 public:
@@ -22,6 +24,10 @@ public:
 	virtual unsigned int	getCategory()const override;
 	float					getMaxSpeed() const;
 	int						getDamage() const;
+	Type					getType() const;
+
+	ProjectileState			saveState() const;
+	void					loadState(const ProjectileState& state);
 	virtual sf::FloatRect	getBoundingRect() const override;
 private:
 	virtual void			drawCurrent(sf::RenderTarget& target, sf::RenderStates states) const override;
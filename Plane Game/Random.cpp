@@ -0,0 +1,90 @@
+#include "Random.h"
+
+#include <random>
+
+namespace
+{
+	const std::uint64_t Multiplier = 6364136223846793005ULL;
+
+	std::uint64_t RootSeed = generateSeed();
+	std::uint64_t NextStream = 0;
+}
+
+RandomStream::RandomStream()
+	: RandomStream(0, 0)
+{
+}
+
+RandomStream::RandomStream(std::uint64_t seed, std::uint64_t stream)
+	: state(0)
+	, increment((stream << 1u) | 1u)
+{
+	next();
+	state += seed;
+	next();
+}
+
+std::uint32_t RandomStream::next()
+{
+	std::uint64_t old = state;
+	state = old * Multiplier + increment;
+
+	std::uint32_t xorShifted = static_cast<std::uint32_t>(((old >> 18u) ^ old) >> 27u);
+	std::uint32_t rotation = static_cast<std::uint32_t>(old >> 59u);
+	return (xorShifted >> rotation) | (xorShifted << ((32u - rotation) & 31u));
+}
+
+int RandomStream::nextInt(int exclusiveMax)
+{
+	// Multiply and shift instead of modulo; the bias is below 2^-32 * exclusiveMax
+	return static_cast<int>((static_cast<std::uint64_t>(next()) * static_cast<std::uint32_t>(exclusiveMax)) >> 32u);
+}
+
+float RandomStream::nextFloat()
+{
+	// 24 bits fill the float mantissa exactly
+	return static_cast<float>(next() >> 8u) * (1.f / 16777216.f);
+}
+
+RandomStream RandomStream::split()
+{
+	// One draw per statement, the order of calls within an expression is unspecified
+	std::uint64_t seed = static_cast<std::uint64_t>(next()) << 32u;
+	seed |= next();
+	std::uint64_t stream = static_cast<std::uint64_t>(next()) << 32u;
+	stream |= next();
+	return RandomStream(seed, stream);
+}
+
+void seedRandom(std::uint64_t seed)
+{
+	RootSeed = seed;
+	NextStream = 0;
+}
+
+std::uint64_t getRandomSeed()
+{
+	return RootSeed;
+}
+
+std::uint64_t getRandomStreamCount()
+{
+	return NextStream;
+}
+
+void restoreRandom(std::uint64_t seed, std::uint64_t streamCount)
+{
+	RootSeed = seed;
+	NextStream = streamCount;
+}
+
+std::uint64_t generateSeed()
+{
+	std::random_device r;
+	return (static_cast<std::uint64_t>(r()) << 32u) | r();
+}
+
+RandomStream createRandomStream()
+{
+	return RandomStream(RootSeed, NextStream++);
+}
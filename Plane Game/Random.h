@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+
+// PCG32 generator: 8 bytes of state plus a stream selector, so any number of
+// independent sequences can be derived from one seed.
+class RandomStream
+{
+public:
+										RandomStream();
+										RandomStream(std::uint64_t seed, std::uint64_t stream);
+
+	std::uint32_t						next();
+	// [0, exclusiveMax)
+	int									nextInt(int exclusiveMax);
+	// [0, 1)
+	float								nextFloat();
+
+	// A new stream seeded from this one, for handing to a subsystem
+	RandomStream						split();
+
+private:
+	std::uint64_t						state;
+	std::uint64_t						increment;
+};
+
+// Mission wide seed. Every stream created afterwards is a function of the seed
+// and its creation index only, so results do not depend on which thread
+// consumes a stream or when.
+void			seedRandom(std::uint64_t seed);
+std::uint64_t	getRandomSeed();
+// Streams created since the seed was set; with the seed it restores the service
+std::uint64_t	getRandomStreamCount();
+void			restoreRandom(std::uint64_t seed, std::uint64_t streamCount);
+std::uint64_t	generateSeed();
+
+// Main thread only; each entity or system keeps its own stream
+RandomStream	createRandomStream();
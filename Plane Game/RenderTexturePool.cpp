@@ -0,0 +1,69 @@
+#include "RenderTexturePool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace
+{
+	// Unused textures survive this many frames before being freed, e.g. after a resize
+	const std::size_t MaxIdleFrames = 120;
+}
+
+RenderTexturePool::RenderTexturePool()
+	: entries()
+	, frame(0)
+{
+}
+
+sf::RenderTexture& RenderTexturePool::acquire(sf::Vector2u size)
+{
+	for (Entry& entry : entries)
+	{
+		if (!entry.inUse && entry.size == size)
+		{
+			entry.inUse = true;
+			entry.lastUsedFrame = frame;
+			return *entry.texture;
+		}
+	}
+
+	std::unique_ptr<sf::RenderTexture> texture(new sf::RenderTexture());
+	if (!texture->create(size.x, size.y))
+		throw std::runtime_error("RenderTexturePool::acquire - Failed to create render texture");
+	texture->setSmooth(true);
+
+	Entry entry;
+	entry.texture = std::move(texture);
+	entry.size = size;
+	entry.inUse = true;
+	entry.lastUsedFrame = frame;
+	entries.push_back(std::move(entry));
+
+	return *entries.back().texture;
+}
+
+void RenderTexturePool::release(const sf::RenderTexture& texture)
+{
+	auto found = std::find_if(entries.begin(), entries.end(),
+		[&texture](const Entry& entry) { return entry.texture.get() == &texture; });
+	assert(found != entries.end() && found->inUse);
+
+	found->inUse = false;
+}
+
+void RenderTexturePool::endFrame()
+{
+	frame += 1;
+
+	auto idle = std::remove_if(entries.begin(), entries.end(), [this](const Entry& entry)
+		{
+			return !entry.inUse && frame - entry.lastUsedFrame > MaxIdleFrames;
+		});
+	entries.erase(idle, entries.end());
+}
+
+std::size_t RenderTexturePool::getTextureCount() const
+{
+	return entries.size();
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+
+#include <memory>
+#include <vector>
+
+// Hands out render textures by size so intermediate targets are shared
+// between passes and effects instead of being owned by each of them
+class RenderTexturePool : private sf::NonCopyable
+{
+public:
+								RenderTexturePool();
+
+	sf::RenderTexture&			acquire(sf::Vector2u size);
+	void						release(const sf::RenderTexture& texture);
+	void						endFrame();
+
+	std::size_t					getTextureCount() const;
+
+private:
+	struct Entry
+	{
+		std::unique_ptr<sf::RenderTexture>	texture;
+		sf::Vector2u						size;
+		bool								inUse;
+		std::size_t							lastUsedFrame;
+	};
+
+private:
+	std::vector<Entry>			entries;
+	std::size_t					frame;
+};
@@ -0,0 +1,166 @@
+#include "Replay.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+	const std::uint32_t Magic = 0x50524750; // "PGRP"
+	const std::uint32_t Version = 2;
+
+	struct FileHeader
+	{
+		std::uint32_t	magic;
+		std::uint32_t	version;
+		std::uint64_t	seed;
+		std::uint32_t	tickCount;
+		std::uint32_t	runCount;
+	};
+
+	// Longer runs are split, a held key rarely lasts 18 minutes anyway
+	struct RunRecord
+	{
+		std::uint16_t	length;
+		std::uint8_t	actions;
+		std::uint8_t	padding;
+	};
+
+	const std::uint32_t MaxRecordLength = 0xffff;
+}
+
+Replay::Replay()
+	: runs()
+	, seed(0)
+	, tickCount(0)
+	, recording(false)
+	, playing(false)
+	, runIndex(0)
+	, runOffset(0)
+{
+}
+
+void Replay::startRecording(std::uint64_t seed)
+{
+	this->seed = seed;
+	runs.clear();
+	tickCount = 0;
+	recording = true;
+	playing = false;
+}
+
+void Replay::record(ActionMask actions)
+{
+	if (!recording)
+		return;
+
+	if (runs.empty() || runs.back().actions != actions)
+		runs.push_back({ actions, 0 });
+	runs.back().length += 1;
+	tickCount += 1;
+}
+
+void Replay::stopRecording()
+{
+	recording = false;
+}
+
+void Replay::startPlayback()
+{
+	recording = false;
+	playing = true;
+	runIndex = 0;
+	runOffset = 0;
+}
+
+bool Replay::next(ActionMask& actions)
+{
+	if (!playing || runIndex == runs.size())
+	{
+		playing = false;
+		return false;
+	}
+
+	actions = runs[runIndex].actions;
+	if (++runOffset == runs[runIndex].length)
+	{
+		runIndex += 1;
+		runOffset = 0;
+	}
+	return true;
+}
+
+void Replay::stopPlayback()
+{
+	playing = false;
+}
+
+bool Replay::isRecording() const
+{
+	return recording;
+}
+
+bool Replay::isPlaying() const
+{
+	return playing;
+}
+
+std::uint64_t Replay::getSeed() const
+{
+	return seed;
+}
+
+std::size_t Replay::getTickCount() const
+{
+	return tickCount;
+}
+
+void Replay::loadFromFile(const std::string& filename)
+{
+	std::ifstream in(filename, std::ios::binary);
+	if (!in)
+		throw std::runtime_error("Replay::loadFromFile - Failed to open " + filename);
+
+	FileHeader header;
+	if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != Magic || header.version != Version)
+		throw std::runtime_error("Replay::loadFromFile - Incompatible file " + filename);
+
+	std::vector<RunRecord> records(header.runCount);
+	if (!in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(RunRecord)))
+		throw std::runtime_error("Replay::loadFromFile - Truncated file " + filename);
+
+	startRecording(header.seed);
+	for (const RunRecord& record : records)
+	{
+		if (!runs.empty() && runs.back().actions == record.actions)
+			runs.back().length += record.length;
+		else
+			runs.push_back({ record.actions, record.length });
+		tickCount += record.length;
+	}
+	recording = false;
+
+	if (tickCount != header.tickCount)
+		throw std::runtime_error("Replay::loadFromFile - Corrupt file " + filename);
+}
+
+bool Replay::saveToFile(const std::string& filename) const
+{
+	std::vector<RunRecord> records;
+	for (const Run& run : runs)
+	{
+		for (std::uint32_t left = run.length; left > 0; )
+		{
+			std::uint32_t length = std::min(left, MaxRecordLength);
+			records.push_back({ static_cast<std::uint16_t>(length), run.actions, 0 });
+			left -= length;
+		}
+	}
+
+	FileHeader header = { Magic, Version, seed, static_cast<std::uint32_t>(tickCount), static_cast<std::uint32_t>(records.size()) };
+
+	std::ofstream out(filename, std::ios::binary);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(RunRecord));
+	return static_cast<bool>(out);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The RNG seed of a mission plus the actions the player triggered on each
+// fixed tick, run length encoded. Playing it back through World reproduces
+// the session exactly.
+class Replay
+{
+public:
+	// One bit per Player::Action
+	using ActionMask = std::uint8_t;
+
+public:
+										Replay();
+
+	void								startRecording(std::uint64_t seed);
+	void								record(ActionMask actions);
+	void								stopRecording();
+
+	void								startPlayback();
+	// False once every recorded tick has been played
+	bool								next(ActionMask& actions);
+	void								stopPlayback();
+
+	bool								isRecording() const;
+	bool								isPlaying() const;
+	std::uint64_t						getSeed() const;
+	std::size_t							getTickCount() const;
+
+	void								loadFromFile(const std::string& filename);
+	bool								saveToFile(const std::string& filename) const;
+
+private:
+	struct Run
+	{
+		ActionMask							actions;
+		std::uint32_t						length;
+	};
+
+private:
+	std::vector<Run>					runs;
+	std::uint64_t						seed;
+	std::size_t							tickCount;
+	bool								recording;
+	bool								playing;
+
+	// Playback cursor
+	std::size_t							runIndex;
+	std::uint32_t						runOffset;
+};
@@ -4,10 +4,54 @@
 #include <map>
 #include <assert.h>
 #include <stdexcept> 
+#include <array>
+#include "ResourceIdentifier.h"
+#include "ResourceLoader.h"
 
+// Resources of a dense identifier live in a flat array, one slot per id
+template <typename R, typename Id, std::size_t Count>
+class ResourceStorage
+{
+public:
+	R* find(Id id) const
+	{
+		return slots[static_cast<std::size_t>(id)].get();
+	}
+
+	bool insert(Id id, std::unique_ptr<R> resource)
+	{
+		std::unique_ptr<R>& slot = slots[static_cast<std::size_t>(id)];
+		if (slot)
+			return false;
+		slot = std::move(resource);
+		return true;
+	}
+
+private:
+	std::array<std::unique_ptr<R>, Count>	slots;
+};
+
+// Identifiers without a known count fall back to a map
 template <typename R, typename Id>
+class ResourceStorage<R, Id, 0>
+{
+public:
+	R* find(Id id) const
+	{
+		auto found = resources.find(id);
+		return found != resources.end() ? found->second.get() : nullptr;
+	}
 
+	bool insert(Id id, std::unique_ptr<R> resource)
+	{
+		return resources.insert(std::make_pair(id, std::move(resource))).second;
+	}
 
+private:
+	std::map<Id, std::unique_ptr<R>>		resources;
+};
+
+template <typename R, typename Id, std::size_t Count>
 class ResourceHolder
 {
 public:
@@ -16,6 +60,13 @@ public:
 	template <typename P>
 	void					load(Id id, const std::string& filename, const P& secondParam);
 
+	// Decodes on the loader's workers, the resource appears once the loader finishes it
+	void					loadAsync(Id id, const std::string& filename, ResourceLoader& loader);
+
+	template <typename P>
+	void					loadAsync(Id id, const std::string& filename, const P& secondParam, ResourceLoader& loader);
+
+	bool					contains(Id id) const;
 	const R&				get(Id id)const;
 	R&						get(Id id);
 
@@ -23,12 +74,12 @@ private:
 	void					insertResource(Id id, std::unique_ptr<R> resource);
 
 private:
-	std::map <Id, std::unique_ptr<R>> resourceMap;
+	ResourceStorage<R, Id, Count>	resources;
 
 };
 
-template <typename R, typename Id>
-void ResourceHolder<R, Id>::load(Id id, const std::string& filename) {
+template <typename R, typename Id, std::size_t Count>
+void ResourceHolder<R, Id, Count>::load(Id id, const std::string& filename) {
 	std::unique_ptr<R> resource(new R());
 	if (!resource->loadFromFile(filename))
 		throw std::runtime_error("ResourceHolder::load - Failed to load " + filename);
@@ -37,9 +88,9 @@ void ResourceHolder<R, Id>::load(Id id, const std::string& filename) {
 }
 
 
-template <typename R, typename Id>
+template <typename R, typename Id, std::size_t Count>
 template <typename P>
-void ResourceHolder<R, Id>::load(Id id, const std::string& filename, const P& secondParam) {
+void ResourceHolder<R, Id, Count>::load(Id id, const std::string& filename, const P& secondParam) {
 	// Create and load resource
 	std::unique_ptr<R> resource(new R());
 	if (!resource->loadFromFile(filename, secondParam))
@@ -49,26 +100,51 @@ void ResourceHolder<R, Id>::load(Id id, const std::string& filename, const P& se
 }
 
 
-template <typename R, typename Id>
-R& ResourceHolder<R, Id>::get(Id id) {
-	auto found = resourceMap.find(id);
-	assert(found != resourceMap.end());
-	return *found->second;
+template <typename R, typename Id, std::size_t Count>
+void ResourceHolder<R, Id, Count>::loadAsync(Id id, const std::string& filename, ResourceLoader& loader) {
+	using Decoder = ResourceDecoder<R>;
+	loader.enqueue(
+		[filename]() { return Decoder::decode(filename); },
+		[this, id, filename](typename Decoder::Staged& staged) { insertResource(id, Decoder::upload(staged, filename)); });
 }
 
 
-template <typename R, typename Id>
-const R& ResourceHolder<R, Id>::get(Id id) const {
-	auto found = resourceMap.find(id);
-	assert(found != resourceMap.end());
-	return *found->second;
+template <typename R, typename Id, std::size_t Count>
+template <typename P>
+void ResourceHolder<R, Id, Count>::loadAsync(Id id, const std::string& filename, const P& secondParam, ResourceLoader& loader) {
+	using Decoder = ResourceDecoder<R>;
+	loader.enqueue(
+		[filename, secondParam]() { return Decoder::decode(filename, secondParam); },
+		[this, id, filename](typename Decoder::Staged& staged) { insertResource(id, Decoder::upload(staged, filename)); });
 }
 
 
-template <typename R, typename Id>
-void ResourceHolder<R, Id>::insertResource(Id id, std::unique_ptr<R> resource)
+template <typename R, typename Id, std::size_t Count>
+bool ResourceHolder<R, Id, Count>::contains(Id id) const {
+	return resources.find(id) != nullptr;
+}
+
+
+template <typename R, typename Id, std::size_t Count>
+R& ResourceHolder<R, Id, Count>::get(Id id) {
+	R* found = resources.find(id);
+	assert(found);
+	return *found;
+}
+
+
+template <typename R, typename Id, std::size_t Count>
+const R& ResourceHolder<R, Id, Count>::get(Id id) const {
+	R* found = resources.find(id);
+	assert(found);
+	return *found;
+}
+
+
+template <typename R, typename Id, std::size_t Count>
+void ResourceHolder<R, Id, Count>::insertResource(Id id, std::unique_ptr<R> resource)
 {
 	// Insert and check success
-	auto inserted = resourceMap.insert(std::make_pair(id, std::move(resource)));
-	assert(inserted.second);
+	bool inserted = resources.insert(id, std::move(resource));
+	assert(inserted);
 }
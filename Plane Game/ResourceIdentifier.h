@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+
 namespace sf
 {
 	class Texture;
@@ -16,12 +18,14 @@ enum class EffectID
 	LaunchMissile,
 	CollectPickup,
 	Button,
+	EffectCount
 };
 
 enum class MusicID
 {
 	MenuTheme,
 	MissionTheme,
+	MusicCount
 };
 
 enum class TextureID
@@ -44,11 +48,13 @@ enum class TextureID
 	Particle,
 	FinishLine,
 	Face,
+	TextureCount
 };
 
 enum class FontID
 {
-	Main
+	Main,
+	FontCount
 };
 
 enum class ShaderID
@@ -56,13 +62,16 @@ enum class ShaderID
 	BrightnessPass,
 	DownSamplePass,
 	GaussianBlurPass,
+	LinearBlurPass,
 	AddPass,
+	ShaderCount
 };
 
-template <typename Resource, typename Identifier>
+// Count is the number of identifiers, 0 for identifiers that are not dense
+template <typename Resource, typename Identifier, std::size_t Count = 0>
 class ResourceHolder;
 
-using TextureHolder_t = ResourceHolder <sf::Texture, TextureID>;
-using FontHolder_t = ResourceHolder <sf::Font, FontID>;
-using ShaderHolder_t = ResourceHolder<sf::Shader, ShaderID>;
-using ShoundBufferHolder_t = ResourceHolder<sf::SoundBuffer, EffectID>;
\ No newline at end of file
+using TextureHolder_t = ResourceHolder <sf::Texture, TextureID, static_cast<std::size_t>(TextureID::TextureCount)>;
+using FontHolder_t = ResourceHolder <sf::Font, FontID, static_cast<std::size_t>(FontID::FontCount)>;
+using ShaderHolder_t = ResourceHolder<sf::Shader, ShaderID, static_cast<std::size_t>(ShaderID::ShaderCount)>;
+using ShoundBufferHolder_t = ResourceHolder<sf::SoundBuffer, EffectID, static_cast<std::size_t>(EffectID::EffectCount)>;
\ No newline at end of file
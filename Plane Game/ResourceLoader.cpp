@@ -0,0 +1,127 @@
+#include "ResourceLoader.h"
+
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Shader.hpp>
+#include <SFML/System/Clock.hpp>
+
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	std::string readFile(const std::string& filename)
+	{
+		std::ifstream file(filename, std::ios::binary);
+		if (!file)
+			throw std::runtime_error("ResourceHolder::load - Failed to load " + filename);
+
+		std::ostringstream contents;
+		contents << file.rdbuf();
+		return contents.str();
+	}
+}
+
+sf::Image ResourceDecoder<sf::Texture>::decode(const std::string& filename)
+{
+	sf::Image image;
+	if (!image.loadFromFile(filename))
+		throw std::runtime_error("ResourceHolder::load - Failed to load " + filename);
+	return image;
+}
+
+std::unique_ptr<sf::Texture> ResourceDecoder<sf::Texture>::upload(Staged& staged, const std::string& filename)
+{
+	std::unique_ptr<sf::Texture> texture(new sf::Texture());
+	if (!texture->loadFromImage(staged))
+		throw std::runtime_error("ResourceHolder::load - Failed to load " + filename);
+	return texture;
+}
+
+ResourceDecoder<sf::Shader>::Staged ResourceDecoder<sf::Shader>::decode(const std::string& vertexFile, const std::string& fragmentFile)
+{
+	Staged sources;
+	sources.vertex = readFile(vertexFile);
+	sources.fragment = readFile(fragmentFile);
+	return sources;
+}
+
+std::unique_ptr<sf::Shader> ResourceDecoder<sf::Shader>::upload(Staged& staged, const std::string& filename)
+{
+	std::unique_ptr<sf::Shader> shader(new sf::Shader());
+	if (!shader->loadFromMemory(staged.vertex, staged.fragment))
+		throw std::runtime_error("ResourceHolder::load - Failed to load " + filename);
+	return shader;
+}
+
+ResourceLoader::ResourceLoader(ThreadPool& workers)
+	: workers(workers)
+	, jobs()
+	, total(0)
+	, completed(0)
+{
+}
+
+void ResourceLoader::then(std::function<void()> callback)
+{
+	Job job;
+	job.finish = std::move(callback);
+	push(std::move(job));
+}
+
+void ResourceLoader::update(sf::Time budget)
+{
+	sf::Clock clock;
+	while (!jobs.empty() && clock.getElapsedTime() < budget)
+	{
+		Job& job = jobs.front();
+		if (job.decoded.valid() && job.decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			break;
+
+		finishFront();
+	}
+}
+
+void ResourceLoader::finishAll()
+{
+	while (!jobs.empty())
+		finishFront();
+}
+
+bool ResourceLoader::isIdle() const
+{
+	return jobs.empty();
+}
+
+float ResourceLoader::getProgress() const
+{
+	if (total == 0)
+		return 1.f;
+
+	return static_cast<float>(completed) / total;
+}
+
+void ResourceLoader::push(Job job)
+{
+	// Progress counts from the first job of a new batch
+	if (jobs.empty())
+	{
+		total = 0;
+		completed = 0;
+	}
+
+	jobs.push_back(std::move(job));
+	total += 1;
+}
+
+void ResourceLoader::finishFront()
+{
+	Job job = std::move(jobs.front());
+	jobs.pop_front();
+
+	// Rethrows load failures from the worker here, on the main thread
+	if (job.decoded.valid())
+		job.decoded.get();
+	job.finish();
+
+	completed += 1;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include "ThreadPool.h"
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace sf
+{
+	class Texture;
+	class Shader;
+}
+
+// How a resource type splits between a worker (file I/O and decoding) and
+// the main thread (anything touching the OpenGL context). By default the
+// whole load happens on the worker.
+template <typename R>
+struct ResourceDecoder
+{
+	using Staged = std::unique_ptr<R>;
+
+	static Staged decode(const std::string& filename)
+	{
+		Staged resource(new R());
+		if (!resource->loadFromFile(filename))
+			throw std::runtime_error("ResourceHolder::load - Failed to load " + filename);
+		return resource;
+	}
+
+	template <typename P>
+	static Staged decode(const std::string& filename, const P& secondParam)
+	{
+		Staged resource(new R());
+		if (!resource->loadFromFile(filename, secondParam))
+			throw std::runtime_error("ResourceHolder::load - Failed to load " + filename);
+		return resource;
+	}
+
+	static std::unique_ptr<R> upload(Staged& staged, const std::string&)
+	{
+		return std::move(staged);
+	}
+};
+
+// Images decode on the worker, the texture upload needs the GL context
+template <>
+struct ResourceDecoder<sf::Texture>
+{
+	using Staged = sf::Image;
+
+	static Staged							decode(const std::string& filename);
+	static std::unique_ptr<sf::Texture>		upload(Staged& staged, const std::string& filename);
+};
+
+// Sources are read on the worker, compiling needs the GL context
+template <>
+struct ResourceDecoder<sf::Shader>
+{
+	struct Staged
+	{
+		std::string							vertex;
+		std::string							fragment;
+	};
+
+	static Staged							decode(const std::string& vertexFile, const std::string& fragmentFile);
+	static std::unique_ptr<sf::Shader>		upload(Staged& staged, const std::string& filename);
+};
+
+// Runs resource loads on the thread pool and finishes them on the main thread.
+// Jobs complete in the order they were queued.
+class ResourceLoader : private sf::NonCopyable
+{
+public:
+	explicit							ResourceLoader(ThreadPool& workers);
+
+	template <typename Decode, typename Finish>
+	void								enqueue(Decode decode, Finish finish);
+	// Runs on the main thread once everything queued before it has finished
+	void								then(std::function<void()> callback);
+
+	// Finishes ready jobs on the calling thread until the time budget runs out
+	void								update(sf::Time budget);
+	void								finishAll();
+
+	bool								isIdle() const;
+	float								getProgress() const;
+
+private:
+	struct Job
+	{
+		std::future<void>				decoded;
+		std::function<void()>			finish;
+	};
+
+private:
+	void								push(Job job);
+	void								finishFront();
+
+private:
+	ThreadPool&							workers;
+	std::deque<Job>						jobs;
+	std::size_t							total;
+	std::size_t							completed;
+};
+
+template <typename Decode, typename Finish>
+void ResourceLoader::enqueue(Decode decode, Finish finish)
+{
+	using Staged = decltype(decode());
+
+	// The worker fills the slot, the main thread empties it
+	auto staged = std::make_shared<Staged>();
+
+	Job job;
+	job.decoded = workers.enqueue([staged, decode]() { *staged = decode(); });
+	job.finish = [staged, finish]() { finish(*staged); };
+	push(std::move(job));
+}
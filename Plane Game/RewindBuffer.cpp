@@ -0,0 +1,195 @@
+#include "RewindBuffer.h"
+
+#include <cassert>
+
+namespace
+{
+	void writeVarint(std::vector<char>& out, std::size_t value)
+	{
+		while (value >= 0x80)
+		{
+			out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<char>(value));
+	}
+
+	std::size_t readVarint(const char*& in)
+	{
+		std::size_t value = 0;
+		for (unsigned int shift = 0; ; shift += 7)
+		{
+			unsigned char byte = static_cast<unsigned char>(*in++);
+			value |= static_cast<std::size_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+				return value;
+		}
+	}
+
+	// Pairs of (zero run, literal run) followed by the literal bytes of current ^ previous
+	void encodeDelta(const std::vector<char>& previous, const std::vector<char>& current, std::vector<char>& out)
+	{
+		out.clear();
+		std::size_t i = 0;
+		const std::size_t size = current.size();
+		auto xorAt = [&](std::size_t index)
+		{
+			return static_cast<char>(current[index] ^ (index < previous.size() ? previous[index] : 0));
+		};
+
+		while (i < size)
+		{
+			std::size_t zeroes = 0;
+			while (i + zeroes < size && xorAt(i + zeroes) == 0)
+				zeroes += 1;
+			i += zeroes;
+
+			// A literal run ends at the first run of 4 zeroes, shorter gaps cost more to encode
+			std::size_t literals = 0;
+			std::size_t gap = 0;
+			while (i + literals + gap < size && gap < 4)
+			{
+				if (xorAt(i + literals + gap) == 0)
+				{
+					gap += 1;
+				}
+				else
+				{
+					literals += gap + 1;
+					gap = 0;
+				}
+			}
+
+			writeVarint(out, zeroes);
+			writeVarint(out, literals);
+			for (std::size_t j = 0; j < literals; ++j)
+				out.push_back(xorAt(i + j));
+			i += literals;
+		}
+	}
+
+	void applyDelta(const std::vector<char>& delta, std::size_t size, std::vector<char>& bytes)
+	{
+		bytes.resize(size, 0);
+
+		const char* in = delta.data();
+		const char* end = in + delta.size();
+		std::size_t i = 0;
+		while (in < end)
+		{
+			i += readVarint(in);
+			std::size_t literals = readVarint(in);
+			for (std::size_t j = 0; j < literals; ++j)
+				bytes[i++] ^= *in++;
+		}
+	}
+}
+
+RewindBuffer::RewindBuffer(std::size_t capacity, std::size_t keyframeInterval, std::size_t byteBudget)
+	: capacity(capacity)
+	, keyframeInterval(keyframeInterval)
+	, byteBudget(byteBudget)
+	, frames()
+	, storedBytes(0)
+	, ticksSinceKeyframe(0)
+	, latest()
+	, scratch()
+{
+}
+
+void RewindBuffer::push(const WorldSnapshot& snapshot)
+{
+	snapshot.writeTo(scratch);
+
+	Frame frame;
+	frame.size = scratch.size();
+	frame.keyframe = frames.empty() || ticksSinceKeyframe + 1 >= keyframeInterval;
+	if (frame.keyframe)
+	{
+		frame.data = scratch;
+		ticksSinceKeyframe = 0;
+	}
+	else
+	{
+		encodeDelta(latest, scratch, frame.data);
+		frame.data.shrink_to_fit();
+		ticksSinceKeyframe += 1;
+	}
+
+	storedBytes += frame.data.size();
+	frames.push_back(std::move(frame));
+	latest.swap(scratch);
+
+	while (frames.size() > capacity || storedBytes > byteBudget)
+		dropOldest();
+}
+
+bool RewindBuffer::stepBack(WorldSnapshot& snapshot)
+{
+	if (frames.size() < 2)
+		return false;
+
+	storedBytes -= frames.back().data.size();
+	frames.pop_back();
+
+	ticksSinceKeyframe = 0;
+	for (auto itr = frames.rbegin(); !itr->keyframe; ++itr)
+		ticksSinceKeyframe += 1;
+
+	decode(frames.size() - 1, latest);
+	snapshot.readFrom(latest.data(), latest.size());
+	return true;
+}
+
+void RewindBuffer::read(std::size_t index, WorldSnapshot& snapshot)
+{
+	decode(index, scratch);
+	snapshot.readFrom(scratch.data(), scratch.size());
+}
+
+void RewindBuffer::clear()
+{
+	frames.clear();
+	storedBytes = 0;
+	ticksSinceKeyframe = 0;
+	latest.clear();
+}
+
+std::size_t RewindBuffer::getTickCount() const
+{
+	return frames.size();
+}
+
+std::size_t RewindBuffer::getByteCount() const
+{
+	return storedBytes;
+}
+
+void RewindBuffer::decode(std::size_t index, std::vector<char>& bytes) const
+{
+	assert(index < frames.size());
+
+	std::size_t keyframe = index;
+	while (!frames[keyframe].keyframe)
+		keyframe -= 1;
+
+	bytes = frames[keyframe].data;
+	for (std::size_t i = keyframe + 1; i <= index; ++i)
+		applyDelta(frames[i].data, frames[i].size, bytes);
+}
+
+void RewindBuffer::dropOldest()
+{
+	// Deltas cannot outlive their keyframe, the whole group goes
+	do
+	{
+		storedBytes -= frames.front().data.size();
+		frames.pop_front();
+	} while (!frames.empty() && !frames.front().keyframe);
+
+	if (frames.empty())
+	{
+		ticksSinceKeyframe = 0;
+		latest.clear();
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "WorldSnapshot.h"
+
+#include <deque>
+#include <vector>
+
+// The last few seconds of World snapshots, one per tick. Every
+// KeyframeInterval ticks the serialized snapshot is stored whole, the ticks
+// between store their XOR against the tick before, with the runs of zero
+// bytes squeezed out. Reading a tick replays at most one keyframe interval
+// of deltas. The oldest keyframe and its deltas go first when the tick or
+// byte limits are exceeded.
+class RewindBuffer
+{
+public:
+										RewindBuffer(std::size_t capacity, std::size_t keyframeInterval, std::size_t byteBudget);
+
+	void								push(const WorldSnapshot& snapshot);
+	// Drops the newest tick and returns the one before it
+	bool								stepBack(WorldSnapshot& snapshot);
+	// index 0 is the oldest tick held
+	void								read(std::size_t index, WorldSnapshot& snapshot);
+
+	void								clear();
+	std::size_t							getTickCount() const;
+	std::size_t							getByteCount() const;
+
+private:
+	struct Frame
+	{
+		std::vector<char>					data;
+		std::size_t							size;
+		bool								keyframe;
+	};
+
+private:
+	void								decode(std::size_t index, std::vector<char>& bytes) const;
+	void								dropOldest();
+
+private:
+	std::size_t							capacity;
+	std::size_t							keyframeInterval;
+	std::size_t							byteBudget;
+
+	std::deque<Frame>					frames;
+	std::size_t							storedBytes;
+	std::size_t							ticksSinceKeyframe;
+
+	// Serialized newest tick, the base for the next delta
+	std::vector<char>					latest;
+	std::vector<char>					scratch;
+};
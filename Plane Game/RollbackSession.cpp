@@ -0,0 +1,393 @@
+#include "RollbackSession.h"
+#include "CoopSession.h"
+#include "World.h"
+#include "Profiler.h"
+
+#include <SFML/Network/UdpSocket.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	enum PacketType : std::uint8_t
+	{
+		Hello,
+		Start,
+		Input,
+		Disconnect,
+	};
+
+	// Same aircraft as in host simulated co-op
+	const int HostIdentifier = CoopSession::HostIdentifier;
+	const int ClientIdentifier = CoopSession::ClientIdentifier;
+
+	// Both peers must step by exactly the same time
+	const sf::Time TimePerTick = sf::seconds(1.f / 60.f);
+	const sf::Time Timeout = sf::seconds(5.f);
+	const sf::Time HelloInterval = sf::seconds(0.5f);
+	const std::uint32_t NoTick = 0xffffffff;
+	// Unacknowledged actions resent with every input packet, at most
+	const std::uint32_t MaxInputsPerPacket = 32;
+	const int DisconnectRepeats = 3;
+
+	const std::size_t InputHeaderSize = 1 + 4 + 4 + 1;
+
+	void writeUint32(std::vector<char>& packet, std::uint32_t value)
+	{
+		for (int i = 0; i < 4; ++i)
+			packet.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+	}
+
+	std::uint32_t readUint32(const std::vector<char>& packet, std::size_t offset)
+	{
+		std::uint32_t value = 0;
+		for (int i = 0; i < 4; ++i)
+			value |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(packet[offset + i])) << (8 * i);
+		return value;
+	}
+}
+
+RollbackSession::RollbackSession(const NetworkSettings& settings, Profiler& profiler)
+	: settings(settings)
+	, profiler(profiler)
+	, link(settings.role == NetworkSettings::Role::Host ? settings.port : static_cast<unsigned short>(sf::Socket::AnyPort))
+	, peerAddress(settings.role == NetworkSettings::Role::Client ? settings.hostAddress : sf::IpAddress::None)
+	, peerPort(settings.role == NetworkSettings::Role::Client ? settings.port : 0)
+	, started(false)
+	, ended(false)
+	, disconnected(false)
+	, sinceHeard()
+	, sinceHello()
+	, hostPlayer(HostIdentifier)
+	, clientPlayer(ClientIdentifier)
+	, startState()
+	, startPacket()
+	, snapshots()
+	, localActions()
+	, remoteActions()
+	, predictedActions()
+	, localHistory(InputDelay, 0)
+	, remoteHistory(InputDelay, 0)
+	, stalledActions(0)
+	, tick(0)
+	, localTickCount(InputDelay)
+	, remoteTickCount(InputDelay)
+	, peerAckCount(0)
+	, mispredictedTick(NoTick)
+	, packet()
+{
+	link.setConditions(settings.lossRate, settings.latency, settings.jitter);
+
+	// The delayed ticks at the start have no actions on either side
+	localActions.fill(0);
+	remoteActions.fill(0);
+	predictedActions.fill(0);
+
+	if (!isHost())
+		sendToPeer({ static_cast<char>(Hello) });
+}
+
+RollbackSession::~RollbackSession()
+{
+	disconnect();
+}
+
+bool RollbackSession::isHost() const
+{
+	return settings.role == NetworkSettings::Role::Host;
+}
+
+bool RollbackSession::isStarted() const
+{
+	return started;
+}
+
+bool RollbackSession::hasEnded() const
+{
+	return ended;
+}
+
+bool RollbackSession::advance(World& world, Replay::ActionMask actions)
+{
+	poll(world);
+
+	// Kept for the tick that finally runs, so no press is lost
+	stalledActions |= actions;
+	if (!started || ended)
+		return false;
+
+	if (tick >= remoteTickCount + MaxRollback)
+	{
+		profiler.addCount("Rollback stalls");
+		sendInputs();
+		return false;
+	}
+
+	localActions[localTickCount % RingSize] = stalledActions;
+	localHistory.push_back(stalledActions);
+	localTickCount += 1;
+	stalledActions = 0;
+
+	simulate(world, tick);
+	tick += 1;
+
+	sendInputs();
+	return true;
+}
+
+void RollbackSession::synchronize(World& world)
+{
+	poll(world);
+	if (started && !ended)
+		sendInputs();
+}
+
+std::uint32_t RollbackSession::getTick() const
+{
+	return tick;
+}
+
+bool RollbackSession::isConfirmed() const
+{
+	return remoteTickCount >= tick && mispredictedTick == NoTick;
+}
+
+bool RollbackSession::isPeerSynchronized(std::uint32_t count) const
+{
+	return peerAckCount >= count;
+}
+
+const std::vector<char>& RollbackSession::getStartState() const
+{
+	return startState;
+}
+
+const std::vector<Replay::ActionMask>& RollbackSession::getHostActions() const
+{
+	return isHost() ? localHistory : remoteHistory;
+}
+
+const std::vector<Replay::ActionMask>& RollbackSession::getClientActions() const
+{
+	return isHost() ? remoteHistory : localHistory;
+}
+
+void RollbackSession::disconnect()
+{
+	if (disconnected)
+		return;
+	disconnected = true;
+
+	if (isHost() && !started)
+		return;
+
+	for (int i = 0; i < DisconnectRepeats; ++i)
+		sendToPeer({ static_cast<char>(Disconnect) });
+	link.flush();
+}
+
+void RollbackSession::poll(World& world)
+{
+	link.update();
+	receive(world);
+
+	bool waiting = !started || (isHost() && peerAckCount == 0);
+	if (!ended && (started || !isHost()) && sinceHeard.getElapsedTime() > Timeout)
+		ended = true;
+
+	// Until the first answer, the client asks and the host repeats the start state
+	if (!ended && waiting && sinceHello.getElapsedTime() >= HelloInterval)
+	{
+		if (!isHost())
+			sendToPeer({ static_cast<char>(Hello) });
+		else if (started)
+			sendToPeer(startPacket);
+		sinceHello.restart();
+	}
+
+	if (started && !ended)
+		rollback(world);
+}
+
+void RollbackSession::receive(World& world)
+{
+	std::vector<char> data;
+	sf::IpAddress address;
+	unsigned short port = 0;
+
+	while (link.receive(data, address, port))
+	{
+		if (data.empty())
+			continue;
+
+		// The host takes the first client that says hello
+		if (isHost() && !started && !disconnected && static_cast<std::uint8_t>(data[0]) == Hello)
+		{
+			peerAddress = address;
+			peerPort = port;
+			start(world);
+			continue;
+		}
+		if (address != peerAddress || port != peerPort)
+			continue;
+
+		sinceHeard.restart();
+		switch (static_cast<std::uint8_t>(data[0]))
+		{
+		case Hello:
+			// The start state was lost
+			if (isHost() && started)
+				sendToPeer(startPacket);
+			break;
+
+		case Start:
+			if (!isHost() && !started)
+				handleStart(data, world);
+			break;
+
+		case Input:
+			if (started)
+				handleInput(data);
+			break;
+
+		case Disconnect:
+			ended = true;
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+void RollbackSession::start(World& world)
+{
+	world.addAircraft(ClientIdentifier);
+
+	WorldSnapshot snapshot;
+	world.saveSnapshot(snapshot);
+	snapshot.writeTo(startState);
+
+	startPacket.clear();
+	startPacket.push_back(static_cast<char>(Start));
+	startPacket.insert(startPacket.end(), startState.begin(), startState.end());
+	if (startPacket.size() > sf::UdpSocket::MaxDatagramSize)
+		throw std::runtime_error("RollbackSession::start - Start state does not fit in one datagram");
+
+	sendToPeer(startPacket);
+	sinceHello.restart();
+	sinceHeard.restart();
+	started = true;
+}
+
+void RollbackSession::handleStart(const std::vector<char>& data, World& world)
+{
+	WorldSnapshot snapshot;
+	try
+	{
+		snapshot.readFrom(data.data() + 1, data.size() - 1);
+	}
+	catch (std::runtime_error&)
+	{
+		// Damaged on the way, the host sends it again
+		return;
+	}
+
+	world.restoreSnapshot(snapshot);
+	startState.assign(data.begin() + 1, data.end());
+	started = true;
+}
+
+void RollbackSession::handleInput(const std::vector<char>& data)
+{
+	if (data.size() < InputHeaderSize)
+		return;
+
+	std::uint32_t first = readUint32(data, 1);
+	std::uint32_t ack = readUint32(data, 5);
+	std::uint32_t count = static_cast<std::uint8_t>(data[9]);
+	if (data.size() < InputHeaderSize + count)
+		return;
+
+	peerAckCount = std::max(peerAckCount, ack);
+
+	// Only the next missing tick is taken, the peer resends from our ack on
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		std::uint32_t inputTick = first + i;
+		if (inputTick != remoteTickCount)
+			continue;
+
+		Replay::ActionMask actions = static_cast<Replay::ActionMask>(data[InputHeaderSize + i]);
+		remoteActions[inputTick % RingSize] = actions;
+		remoteHistory.push_back(actions);
+		remoteTickCount += 1;
+
+		if (inputTick < tick && actions != predictedActions[inputTick % RingSize])
+			mispredictedTick = std::min(mispredictedTick, inputTick);
+	}
+}
+
+void RollbackSession::rollback(World& world)
+{
+	if (mispredictedTick == NoTick)
+		return;
+
+	sf::Clock clock;
+	std::uint32_t resimulated = tick - mispredictedTick;
+
+	world.restoreSnapshot(snapshots[mispredictedTick % snapshots.size()]);
+	world.setResimulating(true);
+	for (std::uint32_t t = mispredictedTick; t < tick; ++t)
+		simulate(world, t);
+	world.setResimulating(false);
+	mispredictedTick = NoTick;
+
+	profiler.addSample("Rollback", clock.getElapsedTime());
+	profiler.setValue("Rollback ticks", static_cast<float>(resimulated));
+}
+
+void RollbackSession::simulate(World& world, std::uint32_t index)
+{
+	// Between ticks, as World::saveSnapshot requires
+	world.saveSnapshot(snapshots[index % snapshots.size()]);
+
+	Replay::ActionMask local = localActions[index % RingSize];
+	Replay::ActionMask remote = getRemoteActions(index);
+	predictedActions[index % RingSize] = remote;
+
+	CommandQueue& commands = world.getCommands();
+	hostPlayer.pushActions(isHost() ? local : remote, commands);
+	clientPlayer.pushActions(isHost() ? remote : local, commands);
+	world.update(TimePerTick);
+}
+
+Replay::ActionMask RollbackSession::getRemoteActions(std::uint32_t index) const
+{
+	if (index < remoteTickCount)
+		return remoteActions[index % RingSize];
+
+	// Held keys usually stay held; a single press is never guessed
+	return remoteActions[(remoteTickCount - 1) % RingSize] & Player::getRealTimeMask();
+}
+
+void RollbackSession::sendInputs()
+{
+	std::uint32_t first = std::max(peerAckCount, localTickCount > MaxInputsPerPacket ? localTickCount - MaxInputsPerPacket : 0);
+	std::uint32_t count = localTickCount - first;
+
+	packet.clear();
+	packet.push_back(static_cast<char>(Input));
+	writeUint32(packet, first);
+	writeUint32(packet, remoteTickCount);
+	packet.push_back(static_cast<char>(count));
+	for (std::uint32_t t = first; t < localTickCount; ++t)
+		packet.push_back(static_cast<char>(localActions[t % RingSize]));
+	sendToPeer(packet);
+}
+
+void RollbackSession::sendToPeer(const std::vector<char>& data)
+{
+	link.send(data, peerAddress, peerPort);
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "NetworkLink.h"
+#include "NetworkSettings.h"
+#include "Player.h"
+#include "Replay.h"
+#include "WorldSnapshot.h"
+
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class World;
+class Profiler;
+
+// GGPO style rollback for two peers that both run the same World. Only
+// actions travel; the peer's are predicted by repeating its last held keys,
+// and when the real ones differ the World is restored to that tick and
+// simulated forward again, at most MaxRollback ticks in one frame.
+class RollbackSession : private sf::NonCopyable
+{
+public:
+	static const std::uint32_t		MaxRollback = 8;
+	// Local actions apply this many ticks late, which hides most of the latency
+	static const std::uint32_t		InputDelay = 2;
+
+public:
+									RollbackSession(const NetworkSettings& settings, Profiler& profiler);
+									~RollbackSession();
+
+	bool							isHost() const;
+	// Both peers run from the host's state
+	bool							isStarted() const;
+	// The peer left or went silent
+	bool							hasEnded() const;
+
+	// Once per frame: corrects mispredicted ticks, then simulates the next tick
+	// with these actions. False while the peer is MaxRollback ticks behind.
+	bool							advance(World& world, Replay::ActionMask actions);
+	// The same without simulating a new tick
+	void							synchronize(World& world);
+
+	// Ticks simulated so far
+	std::uint32_t					getTick() const;
+	// Every simulated tick ran with the peer's real actions
+	bool							isConfirmed() const;
+	// The peer has our actions for the first count ticks
+	bool							isPeerSynchronized(std::uint32_t count) const;
+
+	// For checking against a run without rollback: the serialized state both
+	// peers started from, and every tick's actions known so far
+	const std::vector<char>&		getStartState() const;
+	const std::vector<Replay::ActionMask>&	getHostActions() const;
+	const std::vector<Replay::ActionMask>&	getClientActions() const;
+
+	// Tells the peer, at most once
+	void							disconnect();
+
+private:
+	void							poll(World& world);
+	void							receive(World& world);
+	void							start(World& world);
+	void							handleStart(const std::vector<char>& data, World& world);
+	void							handleInput(const std::vector<char>& data);
+	void							rollback(World& world);
+	void							simulate(World& world, std::uint32_t index);
+	Replay::ActionMask				getRemoteActions(std::uint32_t index) const;
+	void							sendInputs();
+	void							sendToPeer(const std::vector<char>& data);
+
+private:
+	static const std::size_t		RingSize = 64;
+	using ActionRing				= std::array<Replay::ActionMask, RingSize>;
+
+	NetworkSettings					settings;
+	Profiler&						profiler;
+	NetworkLink						link;
+
+	sf::IpAddress					peerAddress;
+	unsigned short					peerPort;
+	bool							started;
+	bool							ended;
+	bool							disconnected;
+	sf::Clock						sinceHeard;
+	sf::Clock						sinceHello;
+
+	// Commands are pushed host first on both peers, so both update alike
+	Player							hostPlayer;
+	Player							clientPlayer;
+
+	// The state both peers start from; the host resends it until the client answers
+	std::vector<char>				startState;
+	std::vector<char>				startPacket;
+	// State before each of the last ticks, indexed by tick
+	std::array<WorldSnapshot, MaxRollback + 1>	snapshots;
+
+	ActionRing						localActions;
+	ActionRing						remoteActions;
+	ActionRing						predictedActions;
+	// The whole mission, a byte per tick each
+	std::vector<Replay::ActionMask>	localHistory;
+	std::vector<Replay::ActionMask>	remoteHistory;
+	Replay::ActionMask				stalledActions;
+
+	std::uint32_t					tick;
+	// Actions known for all ticks below these
+	std::uint32_t					localTickCount;
+	std::uint32_t					remoteTickCount;
+	std::uint32_t					peerAckCount;
+	// Oldest simulated tick whose prediction turned out wrong
+	std::uint32_t					mispredictedTick;
+
+	std::vector<char>				packet;
+};
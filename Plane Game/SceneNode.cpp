@@ -10,6 +10,7 @@ using Ptr = std::unique_ptr<SceneNode>;
 SceneNode::SceneNode(Category::Type category)
 	: children()
 	, parent(nullptr)
+	, registry(nullptr)
 	, defaultCategory(category)
 {
 
@@ -18,6 +19,9 @@ SceneNode::SceneNode(Category::Type category)
 void SceneNode::attachChild(Ptr child)
 {
 	child->parent = this;
+	// A subtree joining the scene resolves its systems once, here
+	if (registry)
+		child->setRegistry(registry);
 	children.push_back(std::move(child));
 }
 
@@ -30,11 +34,34 @@ Ptr SceneNode::detachChild(const SceneNode& node)
 
 	nodeToDetach = std::move(*kid);
 	nodeToDetach->parent = nullptr;
+	nodeToDetach->setRegistry(nullptr);
 	children.erase(kid);
 
 	return nodeToDetach;
 }
 
+void SceneNode::removeChildren(unsigned int categories)
+{
+	auto removedBegin = std::remove_if(children.begin(), children.end(),
+		[categories](Ptr& p) { return (p->getCategory() & categories) != 0; });
+	children.erase(removedBegin, children.end());
+}
+
+void SceneNode::setRegistry(SceneRegistry* sceneRegistry)
+{
+	registry = sceneRegistry;
+	if (registry)
+		onAttach(*registry);
+
+	for (Ptr& child : children)
+		child->setRegistry(sceneRegistry);
+}
+
+SceneRegistry* SceneNode::getRegistry() const
+{
+	return registry;
+}
+
 sf::FloatRect SceneNode::getBoundingRect() const
 {
 	return sf::FloatRect();
@@ -115,6 +142,12 @@ void SceneNode::removeWrecks()
 	std::for_each(children.begin(), children.end(), std::mem_fn(&SceneNode::removeWrecks));
 }
 
+void SceneNode::onAttach(SceneRegistry& sceneRegistry)
+{
+	//default do nothing
+	//to be overridden by derived classes that use shared systems
+}
+
 void SceneNode::updateCurrent(sf::Time dt,CommandQueue& commands)
 {
 	//default do nothing
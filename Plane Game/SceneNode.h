@@ -12,6 +12,7 @@
 //forward declaration
 
 class CommandQueue;
+class SceneRegistry;
 
 class SceneNode : public sf::Transformable, public sf::Drawable, private sf::NonCopyable
 {
@@ -23,6 +24,11 @@ public:
 
 	void						attachChild(Ptr child);
 	Ptr							detachChild(const SceneNode& node);
+	// Drops every direct child in one of the categories
+	void						removeChildren(unsigned int categories);
+
+	void						setRegistry(SceneRegistry* sceneRegistry);
+	SceneRegistry*				getRegistry() const;
 
 	virtual sf::FloatRect		getBoundingRect() const;
 	void						update(sf::Time dt, CommandQueue& commands);
@@ -40,6 +46,7 @@ public:
 	void						checkSceneCollision(SceneNode& sceneGraph, std::set<Pair>& collisionPairs);
 	void						removeWrecks();
 private:
+	virtual void				onAttach(SceneRegistry& sceneRegistry);
 	virtual void				updateCurrent(sf::Time dt, CommandQueue& commands);
 	void						updateChildren(sf::Time dt, CommandQueue& commands);
 
@@ -54,6 +61,7 @@ private:
 
 	std::vector<Ptr>			children;
 	SceneNode*					parent;
+	SceneRegistry*				registry;
 	Category::Type				defaultCategory;
 
 };
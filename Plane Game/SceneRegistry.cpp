@@ -0,0 +1,51 @@
+#include "SceneRegistry.h"
+#include "ParticleNode.h"
+
+#include <cassert>
+
+SceneRegistry::SceneRegistry()
+	: particleSystems()
+	, soundNode(nullptr)
+	, movementSystem(nullptr)
+{
+	particleSystems.fill(nullptr);
+}
+
+void SceneRegistry::registerParticleSystem(ParticleNode& system)
+{
+	ParticleNode*& slot = particleSystems[static_cast<std::size_t>(system.getParticleType())];
+	assert(slot == nullptr || slot == &system);
+	slot = &system;
+}
+
+ParticleNode* SceneRegistry::getParticleSystem(Particle::Type type) const
+{
+	return particleSystems[static_cast<std::size_t>(type)];
+}
+
+const SceneRegistry::ParticleSystemArray& SceneRegistry::getParticleSystems() const
+{
+	return particleSystems;
+}
+
+void SceneRegistry::registerSoundNode(SoundNode& node)
+{
+	assert(soundNode == nullptr || soundNode == &node);
+	soundNode = &node;
+}
+
+SoundNode* SceneRegistry::getSoundNode() const
+{
+	return soundNode;
+}
+
+void SceneRegistry::registerMovementSystem(MovementSystem& system)
+{
+	assert(movementSystem == nullptr || movementSystem == &system);
+	movementSystem = &system;
+}
+
+MovementSystem* SceneRegistry::getMovementSystem() const
+{
+	return movementSystem;
+}
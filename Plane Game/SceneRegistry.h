@@ -0,0 +1,37 @@
+#pragma once
+#include "Particle.h"
+
+#include <SFML/System/NonCopyable.hpp>
+
+#include <array>
+
+class ParticleNode;
+class SoundNode;
+class MovementSystem;
+
+// Lets nodes reach the scene's shared systems directly instead of
+// searching the graph with commands
+class SceneRegistry : private sf::NonCopyable
+{
+public:
+	static const std::size_t ParticleTypeCount = static_cast<std::size_t>(Particle::Type::particleCount);
+	using ParticleSystemArray = std::array<ParticleNode*, ParticleTypeCount>;
+
+public:
+								SceneRegistry();
+
+	void						registerParticleSystem(ParticleNode& system);
+	ParticleNode*				getParticleSystem(Particle::Type type) const;
+	const ParticleSystemArray&	getParticleSystems() const;
+
+	void						registerSoundNode(SoundNode& node);
+	SoundNode*					getSoundNode() const;
+
+	void						registerMovementSystem(MovementSystem& system);
+	MovementSystem*				getMovementSystem() const;
+
+private:
+	ParticleSystemArray			particleSystems;
+	SoundNode*					soundNode;
+	MovementSystem*				movementSystem;
+};
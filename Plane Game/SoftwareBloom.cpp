@@ -0,0 +1,284 @@
+#include "SoftwareBloom.h"
+#include "ThreadPool.h"
+
+#include <SFML/Graphics/Image.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_BLOOM_SSE
+#endif
+
+namespace
+{
+	// Constants from Brightness.frag and GuassianBlur.frag
+	const float Threshold = 0.7f;
+	const float Factor = 4.f;
+	const int BlurRadius = 4;
+	const float BlurWeights[BlurRadius + 1] = { 0.2270270270f, 0.1945945946f, 0.1216216216f, 0.0540540541f, 0.0162162162f };
+
+#ifdef SOFTWARE_BLOOM_SSE
+	using Pixel = __m128;
+
+	inline Pixel loadPixel(const float* p)			{ return _mm_loadu_ps(p); }
+	inline void storePixel(float* p, Pixel v)		{ _mm_storeu_ps(p, v); }
+	inline Pixel splat(float f)						{ return _mm_set1_ps(f); }
+	inline Pixel addPixels(Pixel a, Pixel b)				{ return _mm_add_ps(a, b); }
+	inline Pixel multiply(Pixel a, Pixel b)			{ return _mm_mul_ps(a, b); }
+	inline Pixel saturate(Pixel a)					{ return _mm_min_ps(_mm_max_ps(a, _mm_setzero_ps()), _mm_set1_ps(1.f)); }
+#else
+	struct Pixel
+	{
+		float v[4];
+	};
+
+	inline Pixel loadPixel(const float* p)			{ Pixel r = { { p[0], p[1], p[2], p[3] } }; return r; }
+	inline void storePixel(float* p, Pixel a)		{ for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+	inline Pixel splat(float f)						{ Pixel r = { { f, f, f, f } }; return r; }
+	inline Pixel addPixels(Pixel a, Pixel b)				{ for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+	inline Pixel multiply(Pixel a, Pixel b)			{ for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+	inline Pixel saturate(Pixel a)					{ for (int i = 0; i < 4; ++i) a.v[i] = std::min(std::max(a.v[i], 0.f), 1.f); return a; }
+#endif
+
+	inline int clampIndex(int i, unsigned size)
+	{
+		return std::min(std::max(i, 0), static_cast<int>(size) - 1);
+	}
+}
+
+void SoftwareBloom::Buffer::resize(unsigned w, unsigned h)
+{
+	width = std::max(w, 1u);
+	height = std::max(h, 1u);
+	pixels.resize(static_cast<std::size_t>(width) * height * 4);
+}
+
+float* SoftwareBloom::Buffer::row(unsigned y)
+{
+	return &pixels[static_cast<std::size_t>(y) * width * 4];
+}
+
+const float* SoftwareBloom::Buffer::row(unsigned y) const
+{
+	return &pixels[static_cast<std::size_t>(y) * width * 4];
+}
+
+template <typename Function>
+void SoftwareBloom::forEachRow(unsigned rows, Function fn)
+{
+	// One contiguous band of rows per worker
+	std::size_t taskCount = std::max<std::size_t>(workers.getThreadCount(), 1);
+	unsigned rowsPerTask = static_cast<unsigned>((rows + taskCount - 1) / taskCount);
+
+	std::vector<std::future<void>> tasks;
+	for (unsigned begin = 0; begin < rows; begin += rowsPerTask)
+	{
+		unsigned end = std::min(begin + rowsPerTask, rows);
+		tasks.push_back(workers.enqueue([&fn, begin, end]()
+		{
+			for (unsigned y = begin; y < end; ++y)
+				fn(y);
+		}));
+	}
+
+	for (auto& task : tasks)
+		task.get();
+}
+
+SoftwareBloom::SoftwareBloom(ThreadPool& workers)
+	: workers(workers)
+	, source()
+	, brightness()
+	, firstPass()
+	, firstScratch()
+	, secondPass()
+	, secondScratch()
+	, result()
+	, bytes()
+{
+}
+
+void SoftwareBloom::apply(const sf::Image& input, sf::Image& output)
+{
+	load(input, source);
+
+	filterBright(source, brightness);
+	downsample(brightness, firstPass);
+	blurMultipass(firstPass, firstScratch);
+	downsample(firstPass, secondPass);
+	blurMultipass(secondPass, secondScratch);
+	add(firstPass, secondPass, firstScratch);
+	add(source, firstScratch, result);
+
+	store(result, output);
+}
+
+void SoftwareBloom::load(const sf::Image& image, Buffer& output)
+{
+	sf::Vector2u size = image.getSize();
+	output.resize(size.x, size.y);
+
+	const sf::Uint8* pixels = image.getPixelsPtr();
+	forEachRow(output.height, [&](unsigned y)
+	{
+		const sf::Uint8* in = pixels + static_cast<std::size_t>(y) * size.x * 4;
+		float* out = output.row(y);
+		for (unsigned i = 0; i < size.x * 4; ++i)
+			out[i] = in[i] / 255.f;
+	});
+}
+
+void SoftwareBloom::filterBright(const Buffer& input, Buffer& output)
+{
+	output.resize(input.width, input.height);
+
+	forEachRow(output.height, [&](unsigned y)
+	{
+		const float* in = input.row(y);
+		float* out = output.row(y);
+		for (unsigned x = 0; x < input.width; ++x, in += 4, out += 4)
+		{
+			float luminance = in[0] * 0.2126f + in[1] * 0.7152f + in[2] * 0.0722f;
+			float scale = std::min(std::max(luminance - Threshold, 0.f), 1.f) * Factor;
+			storePixel(out, saturate(multiply(loadPixel(in), splat(scale))));
+		}
+	});
+}
+
+void SoftwareBloom::downsample(const Buffer& input, Buffer& output)
+{
+	output.resize(input.width / 2, input.height / 2);
+
+	// The shader takes 9 bilinear taps one source texel apart around the centre
+	// of each output texel; every tap lands between four source texels
+	forEachRow(output.height, [&](unsigned y)
+	{
+		float* out = output.row(y);
+		for (unsigned x = 0; x < output.width; ++x, out += 4)
+		{
+			Pixel sum = splat(0.f);
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				int y0 = clampIndex(2 * y + dy, input.height);
+				int y1 = clampIndex(2 * y + dy + 1, input.height);
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					int x0 = clampIndex(2 * x + dx, input.width);
+					int x1 = clampIndex(2 * x + dx + 1, input.width);
+					sum = addPixels(sum, loadPixel(input.row(y0) + x0 * 4));
+					sum = addPixels(sum, loadPixel(input.row(y0) + x1 * 4));
+					sum = addPixels(sum, loadPixel(input.row(y1) + x0 * 4));
+					sum = addPixels(sum, loadPixel(input.row(y1) + x1 * 4));
+				}
+			}
+			storePixel(out, saturate(multiply(sum, splat(1.f / 36.f))));
+		}
+	});
+}
+
+void SoftwareBloom::blurMultipass(Buffer& buffer, Buffer& scratch)
+{
+	scratch.resize(buffer.width, buffer.height);
+
+	for (std::size_t count = 0; count < 2; ++count)
+	{
+		blurVertical(buffer, scratch);
+		blurHorizontal(scratch, buffer);
+	}
+}
+
+void SoftwareBloom::blurVertical(const Buffer& input, Buffer& output)
+{
+	forEachRow(output.height, [&](unsigned y)
+	{
+		const float* rows[2 * BlurRadius + 1];
+		for (int k = -BlurRadius; k <= BlurRadius; ++k)
+			rows[k + BlurRadius] = input.row(clampIndex(static_cast<int>(y) + k, input.height));
+
+		float* out = output.row(y);
+		for (unsigned x = 0; x < input.width; ++x)
+		{
+			Pixel sum = multiply(loadPixel(rows[BlurRadius] + x * 4), splat(BlurWeights[0]));
+			for (int k = 1; k <= BlurRadius; ++k)
+			{
+				Pixel pair = addPixels(loadPixel(rows[BlurRadius - k] + x * 4), loadPixel(rows[BlurRadius + k] + x * 4));
+				sum = addPixels(sum, multiply(pair, splat(BlurWeights[k])));
+			}
+			storePixel(out + x * 4, saturate(sum));
+		}
+	});
+}
+
+void SoftwareBloom::blurHorizontal(const Buffer& input, Buffer& output)
+{
+	forEachRow(output.height, [&](unsigned y)
+	{
+		const float* in = input.row(y);
+		float* out = output.row(y);
+		for (unsigned x = 0; x < input.width; ++x)
+		{
+			Pixel sum = multiply(loadPixel(in + x * 4), splat(BlurWeights[0]));
+			for (int k = 1; k <= BlurRadius; ++k)
+			{
+				int left = clampIndex(static_cast<int>(x) - k, input.width);
+				int right = clampIndex(static_cast<int>(x) + k, input.width);
+				Pixel pair = addPixels(loadPixel(in + left * 4), loadPixel(in + right * 4));
+				sum = addPixels(sum, multiply(pair, splat(BlurWeights[k])));
+			}
+			storePixel(out + x * 4, saturate(sum));
+		}
+	});
+}
+
+void SoftwareBloom::add(const Buffer& source, const Buffer& bloom, Buffer& output)
+{
+	output.resize(source.width, source.height);
+
+	// Bloom is smaller than the source, upsample it bilinearly like the GPU does
+	const float scaleX = static_cast<float>(bloom.width) / source.width;
+	const float scaleY = static_cast<float>(bloom.height) / source.height;
+
+	forEachRow(output.height, [&](unsigned y)
+	{
+		float sy = (y + 0.5f) * scaleY - 0.5f;
+		int y0 = static_cast<int>(std::floor(sy));
+		float fy = sy - y0;
+		const float* row0 = bloom.row(clampIndex(y0, bloom.height));
+		const float* row1 = bloom.row(clampIndex(y0 + 1, bloom.height));
+
+		const float* in = source.row(y);
+		float* out = output.row(y);
+		for (unsigned x = 0; x < source.width; ++x)
+		{
+			float sx = (x + 0.5f) * scaleX - 0.5f;
+			int x0 = static_cast<int>(std::floor(sx));
+			float fx = sx - x0;
+			int left = clampIndex(x0, bloom.width) * 4;
+			int right = clampIndex(x0 + 1, bloom.width) * 4;
+
+			Pixel top = addPixels(multiply(loadPixel(row0 + left), splat(1.f - fx)), multiply(loadPixel(row0 + right), splat(fx)));
+			Pixel bottom = addPixels(multiply(loadPixel(row1 + left), splat(1.f - fx)), multiply(loadPixel(row1 + right), splat(fx)));
+			Pixel sample = addPixels(multiply(top, splat(1.f - fy)), multiply(bottom, splat(fy)));
+
+			storePixel(out + x * 4, saturate(addPixels(loadPixel(in + x * 4), sample)));
+		}
+	});
+}
+
+void SoftwareBloom::store(const Buffer& input, sf::Image& image)
+{
+	bytes.resize(input.pixels.size());
+
+	forEachRow(input.height, [&](unsigned y)
+	{
+		const float* in = input.row(y);
+		sf::Uint8* out = &bytes[static_cast<std::size_t>(y) * input.width * 4];
+		for (unsigned i = 0; i < input.width * 4; ++i)
+			out[i] = static_cast<sf::Uint8>(in[i] * 255.f + 0.5f);
+	});
+
+	image.create(input.width, input.height, bytes.data());
+}
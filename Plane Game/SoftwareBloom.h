@@ -0,0 +1,59 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/Config.hpp>
+
+#include <vector>
+
+namespace sf
+{
+	class Image;
+}
+class ThreadPool;
+
+// CPU version of the BloomEffect shader chain, for targets without shader
+// support and for offline captures. Kernels match the high quality tier.
+class SoftwareBloom : private sf::NonCopyable
+{
+public:
+	explicit				SoftwareBloom(ThreadPool& workers);
+
+	void					apply(const sf::Image& input, sf::Image& output);
+
+private:
+	// Linear RGBA floats, four per pixel so one pixel fills an SSE register
+	struct Buffer
+	{
+		void				resize(unsigned w, unsigned h);
+		float*				row(unsigned y);
+		const float*		row(unsigned y) const;
+
+		std::vector<float>	pixels;
+		unsigned			width = 0;
+		unsigned			height = 0;
+	};
+
+private:
+	void					load(const sf::Image& image, Buffer& output);
+	void					filterBright(const Buffer& input, Buffer& output);
+	void					downsample(const Buffer& input, Buffer& output);
+	void					blurMultipass(Buffer& buffer, Buffer& scratch);
+	void					blurVertical(const Buffer& input, Buffer& output);
+	void					blurHorizontal(const Buffer& input, Buffer& output);
+	void					add(const Buffer& source, const Buffer& bloom, Buffer& output);
+	void					store(const Buffer& input, sf::Image& image);
+
+	template <typename Function>
+	void					forEachRow(unsigned rows, Function fn);
+
+private:
+	ThreadPool&				workers;
+
+	Buffer					source;
+	Buffer					brightness;
+	Buffer					firstPass;
+	Buffer					firstScratch;
+	Buffer					secondPass;
+	Buffer					secondScratch;
+	Buffer					result;
+	std::vector<sf::Uint8>	bytes;
+};
@@ -1,15 +1,33 @@
 #include "SoundNode.h"
 #include "SoundPlayer.h"
+#include "SceneRegistry.h"
 
 SoundNode::SoundNode(SoundPlayer& player)
     :SceneNode()
     ,sounds(player)
+    ,events()
 {
 }
 
 void SoundNode::playSound(EffectID effect, sf::Vector2f position)
 {
-    sounds.play(effect, position);
+    events.push_back({ effect, position });
+}
+
+void SoundNode::dispatch()
+{
+    sounds.play(events);
+    events.clear();
+}
+
+void SoundNode::discard()
+{
+    events.clear();
+}
+
+void SoundNode::onAttach(SceneRegistry& registry)
+{
+    registry.registerSoundNode(*this);
 }
 
 unsigned int SoundNode::getCategory() const
@@ -2,16 +2,26 @@
 #include "ResourceIdentifier.h"
 #include "SceneNode.h"
 #include "SoundPlayer.h"
+#include <vector>
+
+// Collects the sound requests of one tick and hands them over in one batch
 class SoundNode : public SceneNode
 {
 public:
 								SoundNode(SoundPlayer& player);
 	void						playSound(EffectID effect, sf::Vector2f position);
+	void						dispatch();
+	// Drops this tick's requests, for ticks that are simulated again
+	void						discard();
 
 	virtual unsigned int		getCategory() const override;
 
+private:
+	virtual void				onAttach(SceneRegistry& registry) override;
+
 private:
 	SoundPlayer&				sounds;
+	std::vector<SoundEvent>		events;
 
 };
 
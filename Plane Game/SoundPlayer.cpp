@@ -1,5 +1,7 @@
 #include "SoundPlayer.h"
+#include "EnumArray.h"
 #include <cmath>
+#include <algorithm>
 #include <SFML/Audio/Listener.hpp>
 namespace
 {
@@ -9,21 +11,66 @@ namespace
 	const float Attenuation = 8.f;
 	const float MinDistance2D = 200.f;
 	const float MinDistance3D = std::sqrt(MinDistance2D * MinDistance2D + ListenerZ * ListenerZ);
+
+	// Beyond this the inverse distance model is below MinGain
+	const float MinGain = 0.05f;
+	const float AudibleDistance3D = MinDistance3D * (1.f + (1.f / MinGain - 1.f) / Attenuation);
+
+	// Same effect started this close in the same tick plays once
+	const float MergeDistance = 50.f;
+
+	struct EffectSettings
+	{
+		int				priority;
+		std::size_t		maxInstances;
+	};
+
+	using EffectTable = EnumArray<EffectID, EffectSettings, enumCount(EffectID::EffectCount)>;
+
+	EffectTable initializeEffectSettings()
+	{
+		EffectTable data;
+		data[EffectID::AlliedGunfire] = { 2, 4 };
+		data[EffectID::EnemyGunfire] = { 0, 6 };
+		data[EffectID::Explosion1] = { 3, 4 };
+		data[EffectID::Explosion2] = { 3, 4 };
+		data[EffectID::LaunchMissile] = { 2, 2 };
+		data[EffectID::CollectPickup] = { 4, 2 };
+		data[EffectID::Button] = { 5, 2 };
+		return data;
+	}
+
+	const EffectTable Effects = initializeEffectSettings();
+
+	float distanceSquared(sf::Vector2f lhs, sf::Vector2f rhs)
+	{
+		sf::Vector2f d = lhs - rhs;
+		return d.x * d.x + d.y * d.y;
+	}
 }
 
-SoundPlayer::SoundPlayer()
+SoundPlayer::SoundPlayer(ResourceLoader& loader)
 	: soundBuffers()
-	, sounds()
-{
-	soundBuffers.load(EffectID::AlliedGunfire, "Media/Sound/AlliedGunfire.wav");
-	soundBuffers.load(EffectID::EnemyGunfire, "Media/Sound/EnemyGunfire.wav");
-	soundBuffers.load(EffectID::Explosion1, "Media/Sound/Explosion1.wav");
-	soundBuffers.load(EffectID::Explosion2, "Media/Sound/Explosion2.wav");
-	soundBuffers.load(EffectID::LaunchMissile, "Media/Sound/LaunchMissile.wav");
-	soundBuffers.load(EffectID::CollectPickup, "Media/Sound/CollectPickup.wav");
-	soundBuffers.load(EffectID::Button, "Media/Sound/Button.wav");
+	, voices()
+	, tick(0)
+	, listener()
+	, accepted()
+{
+	soundBuffers.loadAsync(EffectID::AlliedGunfire, "Media/Sound/AlliedGunfire.wav", loader);
+	soundBuffers.loadAsync(EffectID::EnemyGunfire, "Media/Sound/EnemyGunfire.wav", loader);
+	soundBuffers.loadAsync(EffectID::Explosion1, "Media/Sound/Explosion1.wav", loader);
+	soundBuffers.loadAsync(EffectID::Explosion2, "Media/Sound/Explosion2.wav", loader);
+	soundBuffers.loadAsync(EffectID::LaunchMissile, "Media/Sound/LaunchMissile.wav", loader);
+	soundBuffers.loadAsync(EffectID::CollectPickup, "Media/Sound/CollectPickup.wav", loader);
+	soundBuffers.loadAsync(EffectID::Button, "Media/Sound/Button.wav", loader);
 	// Listener points towards the screen (default in SFML)
 	sf::Listener::setDirection(0.f, 0.f, -1.f);
+
+	for (Voice& voice : voices)
+	{
+		voice.sound.setAttenuation(Attenuation);
+		voice.sound.setMinDistance(MinDistance3D);
+	}
 }
 
 void SoundPlayer::play(EffectID effect)
@@ -33,30 +80,112 @@ void SoundPlayer::play(EffectID effect)
 
 void SoundPlayer::play(EffectID effect, sf::Vector2f position)
 {
-	sounds.push_back(sf::Sound());
-	sf::Sound& sound = sounds.back();
-	sound.setBuffer(soundBuffers.get(effect));
-	sound.setPosition(position.x, -position.y, 0.f);
-	sound.setAttenuation(Attenuation);
-	sound.setMinDistance(MinDistance3D);
-	sound.play();
+	Voice* voice = findVoice(effect, position);
+	if (!voice)
+		return;
+
+	voice->sound.stop();
+	voice->sound.setBuffer(soundBuffers.get(effect));
+	voice->sound.setPosition(position.x, -position.y, 0.f);
+	voice->sound.play();
+	voice->effect = effect;
+	voice->position = position;
+	voice->startTick = tick;
 }
 
-void SoundPlayer::removeStoppedSounds()
+void SoundPlayer::play(const std::vector<SoundEvent>& events)
 {
-	sounds.remove_if([](const sf::Sound& s)
+	accepted.clear();
+	for (const SoundEvent& event : events)
+	{
+		if (!isAudible(event.position))
+			continue;
+
+		auto duplicate = std::find_if(accepted.begin(), accepted.end(), [&event](const SoundEvent& other)
 		{
-			return s.getStatus() == sf::Sound::Stopped;
+			return other.effect == event.effect
+				&& distanceSquared(other.position, event.position) < MergeDistance * MergeDistance;
 		});
+		if (duplicate != accepted.end())
+			continue;
+
+		accepted.push_back(event);
+		play(event.effect, event.position);
+	}
+}
+
+void SoundPlayer::update()
+{
+	tick += 1;
 }
 
 void SoundPlayer::setListenerPosition(sf::Vector2f position)
 {
 	sf::Listener::setPosition(position.x,-position.y,ListenerZ);
+	listener = position;
 }
 
 sf::Vector2f SoundPlayer::getListenerPosition()
 {
-	auto pos = sf::Listener::getPosition();
-	return  sf::Vector2f(pos.x, pos.y);
+	return listener;
+}
+
+bool SoundPlayer::isAudible(sf::Vector2f position) const
+{
+	return distanceSquared(position, listener) + ListenerZ * ListenerZ < AudibleDistance3D * AudibleDistance3D;
+}
+
+SoundPlayer::Voice* SoundPlayer::findVoice(EffectID effect, sf::Vector2f position)
+{
+	const EffectSettings& settings = Effects[effect];
+
+	Voice* freeVoice = nullptr;
+	Voice* oldestInstance = nullptr;
+	Voice* victim = nullptr;
+	std::size_t instances = 0;
+
+	// One pass over the pool gathers everything the decision needs
+	for (Voice& voice : voices)
+	{
+		if (voice.sound.getStatus() == sf::Sound::Stopped)
+		{
+			if (!freeVoice)
+				freeVoice = &voice;
+			continue;
+		}
+
+		if (voice.effect == effect)
+		{
+			if (voice.startTick == tick && distanceSquared(voice.position, position) < MergeDistance * MergeDistance)
+				return nullptr;
+
+			instances += 1;
+			if (!oldestInstance || voice.startTick < oldestInstance->startTick)
+				oldestInstance = &voice;
+		}
+
+		// Least important first, then farthest from the listener, then oldest
+		if (!victim)
+		{
+			victim = &voice;
+			continue;
+		}
+		int priority = Effects[voice.effect].priority;
+		int victimPriority = Effects[victim->effect].priority;
+		float distance = distanceSquared(voice.position, listener);
+		float victimDistance = distanceSquared(victim->position, listener);
+		if (priority < victimPriority
+			|| (priority == victimPriority && distance > victimDistance)
+			|| (priority == victimPriority && distance == victimDistance && voice.startTick < victim->startTick))
+			victim = &voice;
+	}
+
+	// At the cap the newest shot replaces the oldest of its kind
+	if (instances >= settings.maxInstances)
+		return oldestInstance;
+	if (freeVoice)
+		return freeVoice;
+	if (victim && Effects[victim->effect].priority <= settings.priority)
+		return victim;
+	return nullptr;
 }
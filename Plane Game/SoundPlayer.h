@@ -6,21 +6,53 @@
 #include <SFML/System/NonCopyable.hpp>
 #include <SFML/Audio/SoundBuffer.hpp>
 #include <SFML/Audio/Sound.hpp>
-#include <list>
+#include <array>
+#include <cstdint>
+#include <vector>
 
+struct SoundEvent
+{
+	EffectID					effect;
+	sf::Vector2f				position;
+};
+
+// Plays effects on a fixed pool of voices. Each effect has a priority and a
+// cap on concurrent instances; when the pool is full the least important,
+// farthest, oldest voice is stolen. Identical effects fired close together
+// in the same tick play once.
 class SoundPlayer : private sf::NonCopyable
 {
 public:
-								SoundPlayer();
+	explicit					SoundPlayer(ResourceLoader& loader);
 	void						play(EffectID effect);
 	void						play(EffectID effect, sf::Vector2f position);
+	// Plays one tick of events; inaudible and duplicate events are dropped
+	void						play(const std::vector<SoundEvent>& events);
 
-	void						removeStoppedSounds();
+	// Once per tick, starts a new merge window
+	void						update();
 	void						setListenerPosition(sf::Vector2f position);
 	sf::Vector2f				getListenerPosition();
 
+private:
+	struct Voice
+	{
+		sf::Sound					sound;
+		EffectID					effect;
+		sf::Vector2f				position;
+		std::uint64_t				startTick;
+	};
+
+	static const std::size_t	VoiceCount = 32;
+
+private:
+	Voice*						findVoice(EffectID effect, sf::Vector2f position);
+	bool						isAudible(sf::Vector2f position) const;
+
 private:
 	ShoundBufferHolder_t		soundBuffers;
-	std::list<sf::Sound>		sounds;
+	std::array<Voice, VoiceCount>	voices;
+	std::uint64_t				tick;
+	sf::Vector2f				listener;
+	std::vector<SoundEvent>		accepted;
 };
-
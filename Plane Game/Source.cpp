@@ -1,17 +1,121 @@
-
 #include "Application.h"
+#include "Benchmark.h"
+#include "Headless.h"
+#include "StressTest.h"
 
 #include <stdexcept>
 #include <iostream>
-int main()
+#include <string>
+#include <cstdlib>
+#include <sstream>
+int main(int argc, char* argv[])
 {
 	try 
 	{
-		Application app;
+		// --bench <name> runs a benchmark instead of the game
+		if (argc >= 3 && std::string(argv[1]) == "--bench")
+			return runBenchmark(argv[2]);
+
+		// --replay <file> plays a recorded mission, add --headless to run it flat out
+		std::string replayFile;
+		if (argc >= 3 && std::string(argv[1]) == "--replay")
+		{
+			if (argc >= 4 && std::string(argv[3]) == "--headless")
+				return runHeadlessReplay(argv[2]);
+			replayFile = argv[2];
+		}
+
+		// --host [port] or --join <address> [port] starts co-op, --rollback has
+		// both sides simulate. --loss <0..1>, --latency <ms> and --jitter <ms>
+		// degrade what this side sends. --rollback-test runs the headless
+		// determinism check instead, one process hosting and one joining.
+		// --snapshot <file> starts the mission from a saved state, such as the
+		// Checkpoint.snap F5 writes.
+		// --stress prints update and draw times against entity count instead;
+		// --enemies, --bullets, --missiles, --pickups and --particles <count>,
+		// --density <x>, --seed <n> and --scales <a,b,...> shape the scene, and
+		// --rendered shows it in a window.
+		NetworkSettings network;
+		bool rollbackTest = false;
+		StressScenario stress;
+		bool stressTest = false;
+		std::string snapshotFile;
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string option = argv[i];
+			bool hasValue = i + 1 < argc && argv[i + 1][0] != '-';
+
+			if (option == "--host")
+			{
+				network.role = NetworkSettings::Role::Host;
+				if (hasValue)
+					network.port = static_cast<unsigned short>(std::atoi(argv[++i]));
+			}
+			else if (option == "--join" && hasValue)
+			{
+				network.role = NetworkSettings::Role::Client;
+				network.hostAddress = sf::IpAddress(argv[++i]);
+				if (i + 1 < argc && argv[i + 1][0] != '-')
+					network.port = static_cast<unsigned short>(std::atoi(argv[++i]));
+			}
+			else if (option == "--rollback")
+				network.rollback = true;
+			else if (option == "--rollback-test")
+				rollbackTest = true;
+			else if (option == "--loss" && hasValue)
+				network.lossRate = static_cast<float>(std::atof(argv[++i]));
+			else if (option == "--latency" && hasValue)
+				network.latency = sf::milliseconds(std::atoi(argv[++i]));
+			else if (option == "--jitter" && hasValue)
+				network.jitter = sf::milliseconds(std::atoi(argv[++i]));
+			else if (option == "--snapshot" && hasValue)
+				snapshotFile = argv[++i];
+			else if (option == "--stress")
+				stressTest = true;
+			else if (option == "--rendered")
+				stress.rendered = true;
+			else if (option == "--enemies" && hasValue)
+				stress.enemies = static_cast<std::size_t>(std::atoi(argv[++i]));
+			else if (option == "--bullets" && hasValue)
+				stress.bullets = static_cast<std::size_t>(std::atoi(argv[++i]));
+			else if (option == "--missiles" && hasValue)
+				stress.missiles = static_cast<std::size_t>(std::atoi(argv[++i]));
+			else if (option == "--pickups" && hasValue)
+				stress.pickups = static_cast<std::size_t>(std::atoi(argv[++i]));
+			else if (option == "--particles" && hasValue)
+				stress.particles = static_cast<std::size_t>(std::atoi(argv[++i]));
+			else if (option == "--density" && hasValue)
+				stress.density = static_cast<float>(std::atof(argv[++i]));
+			else if (option == "--seed" && hasValue)
+				stress.seed = std::strtoull(argv[++i], nullptr, 10);
+			else if (option == "--scales" && hasValue)
+			{
+				stress.scales.clear();
+				std::istringstream scales(argv[++i]);
+				std::string scale;
+				while (std::getline(scales, scale, ','))
+					stress.scales.push_back(static_cast<float>(std::atof(scale.c_str())));
+			}
+		}
+
+		if (stressTest)
+			return runStressTest(stress);
+
+		if (rollbackTest && network.role != NetworkSettings::Role::Offline)
+			return runRollbackTest(network);
+
+		// A replay only matches the mission from its own start
+		if (!replayFile.empty() && !snapshotFile.empty())
+		{
+			std::cout << "--snapshot cannot be combined with --replay" << std::endl;
+			return 1;
+		}
+
+		Application app(replayFile, network, snapshotFile);
 		app.run();
 	}
 	catch (std::exception& e)
 	{
 		std::cout << "\n\nEXCEPTION:" << e.what() << std::endl;
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,273 @@
+#include "SpawnScheduler.h"
+#include "WorldSnapshot.h"
+
+#include <algorithm>
+
+namespace
+{
+	// How many ticks ahead spawns get constructed
+	const float PrebuildTicks = 10.f;
+	// Aircraft constructed ahead of time per tick, due spawns ignore it
+	const std::size_t BuildsPerTick = 4;
+
+	// Min-heap order, ties go to the earlier scheduled spawn
+	template <typename Item>
+	bool laterThan(const Item& lhs, const Item& rhs)
+	{
+		if (lhs.key != rhs.key)
+			return lhs.key > rhs.key;
+		return lhs.sequence > rhs.sequence;
+	}
+
+	// Offset of member i in a formation, as (x, distance)
+	sf::Vector2f formationOffset(const SpawnRequest& request, std::size_t i)
+	{
+		float spacing = request.spacing;
+		switch (request.formation)
+		{
+		case Formation::Line:
+			return sf::Vector2f((i - (request.count - 1) / 2.f) * spacing, 0.f);
+		case Formation::Column:
+			return sf::Vector2f(0.f, i * spacing);
+		case Formation::Vee:
+		{
+			// Leader in front, the others alternate left and right behind it
+			float rank = static_cast<float>((i + 1) / 2);
+			float side = (i % 2 == 1) ? -1.f : 1.f;
+			return sf::Vector2f(side * rank * spacing, rank * spacing);
+		}
+		default:
+			return sf::Vector2f();
+		}
+	}
+}
+
+SpawnScheduler::SpawnScheduler(Factory factory)
+	: factory(std::move(factory))
+	, elapsedTime(sf::Time::Zero)
+	, sequence(0)
+	, entries()
+	, freeEntries()
+	, distanceHeap()
+	, timeHeap()
+	, upcomingByDistance()
+	, upcomingByTime()
+{
+}
+
+void SpawnScheduler::scheduleAtDistance(const SpawnRequest& request, float distance, sf::Time delay)
+{
+	push(distanceHeap, distance, allocate(request, distance, delay, delay == sf::Time::Zero));
+}
+
+void SpawnScheduler::scheduleAtTime(const SpawnRequest& request, sf::Time time)
+{
+	push(timeHeap, time.asSeconds(), allocate(request, 0.f, sf::Time::Zero, false));
+}
+
+void SpawnScheduler::update(sf::Time dt, float distance, float speed, std::vector<Spawn>& output)
+{
+	elapsedTime += dt;
+	const float now = elapsedTime.asSeconds();
+	const float distanceHorizon = distance + speed * dt.asSeconds() * PrebuildTicks;
+	const float timeHorizon = now + dt.asSeconds() * PrebuildTicks;
+
+	// Delayed distance spawns move to the time heap once reached,
+	// the rest move out as soon as they come within the horizon
+	while (!distanceHeap.empty() && distanceHeap.front().key <= distanceHorizon)
+	{
+		Entry& entry = entries[distanceHeap.front().entry];
+		if (entry.anchored)
+			upcomingByDistance.push_back(pop(distanceHeap));
+		else if (distanceHeap.front().key <= distance)
+			push(timeHeap, now + entry.delay.asSeconds(), pop(distanceHeap).entry);
+		else
+			break;
+	}
+
+	while (!timeHeap.empty() && timeHeap.front().key <= timeHorizon)
+		upcomingByTime.push_back(pop(timeHeap));
+
+	// Spread construction of what is coming up over the ticks before it is due
+	std::size_t budget = BuildsPerTick;
+	for (auto itr = upcomingByDistance.begin(); itr != upcomingByDistance.end() && budget > 0; ++itr)
+		budget -= build(entries[itr->entry], budget);
+	for (auto itr = upcomingByTime.begin(); itr != upcomingByTime.end() && budget > 0; ++itr)
+		budget -= build(entries[itr->entry], budget);
+
+	while (!upcomingByDistance.empty() && upcomingByDistance.front().key <= distance)
+	{
+		release(upcomingByDistance.front().entry, distance, output);
+		upcomingByDistance.pop_front();
+	}
+
+	while (!upcomingByTime.empty() && upcomingByTime.front().key <= now)
+	{
+		release(upcomingByTime.front().entry, distance, output);
+		upcomingByTime.pop_front();
+	}
+}
+
+std::size_t SpawnScheduler::getScheduledCount() const
+{
+	return entries.size() - freeEntries.size();
+}
+
+void SpawnScheduler::saveState(WorldSnapshot& snapshot) const
+{
+	snapshot.world.spawnSequence = sequence;
+	snapshot.world.spawnTime = elapsedTime.asMicroseconds();
+
+	auto save = [this, &snapshot](const HeapItem& item, ScheduledSpawnState::Queue queue)
+	{
+		const Entry& entry = entries[item.entry];
+		ScheduledSpawnState state;
+		state.sequence = item.sequence;
+		state.delay = entry.delay.asMicroseconds();
+		state.type = static_cast<std::int32_t>(entry.request.type);
+		state.x = entry.request.x;
+		state.formation = static_cast<std::int32_t>(entry.request.formation);
+		state.count = static_cast<std::uint32_t>(entry.request.count);
+		state.spacing = entry.request.spacing;
+		state.distance = entry.distance;
+		state.key = item.key;
+		state.queue = queue;
+		state.anchored = entry.anchored;
+		state.padding[0] = state.padding[1] = 0;
+
+		std::int32_t index = static_cast<std::int32_t>(snapshot.spawns.size());
+		snapshot.spawns.push_back(state);
+		for (const auto& aircraft : entry.built)
+		{
+			snapshot.aircraft.push_back(aircraft->saveState());
+			snapshot.aircraft.back().scheduled = index;
+		}
+	};
+
+	// Heap arrays are saved as laid out, so they come back already ordered
+	for (const HeapItem& item : distanceHeap)
+		save(item, ScheduledSpawnState::DistanceHeap);
+	for (const HeapItem& item : timeHeap)
+		save(item, ScheduledSpawnState::TimeHeap);
+	for (const HeapItem& item : upcomingByDistance)
+		save(item, ScheduledSpawnState::UpcomingByDistance);
+	for (const HeapItem& item : upcomingByTime)
+		save(item, ScheduledSpawnState::UpcomingByTime);
+}
+
+void SpawnScheduler::loadState(const WorldSnapshot& snapshot)
+{
+	sequence = snapshot.world.spawnSequence;
+	elapsedTime = sf::microseconds(snapshot.world.spawnTime);
+	entries.clear();
+	freeEntries.clear();
+	distanceHeap.clear();
+	timeHeap.clear();
+	upcomingByDistance.clear();
+	upcomingByTime.clear();
+
+	for (const ScheduledSpawnState& state : snapshot.spawns)
+	{
+		SpawnRequest request = { static_cast<Aircraft::Type>(state.type), state.x,
+			static_cast<Formation>(state.formation), state.count, state.spacing };
+		std::size_t index = allocate(request, state.distance, sf::microseconds(state.delay), state.anchored != 0);
+		HeapItem item = { state.key, state.sequence, index };
+
+		switch (state.queue)
+		{
+		case ScheduledSpawnState::DistanceHeap:
+			distanceHeap.push_back(item);
+			break;
+		case ScheduledSpawnState::TimeHeap:
+			timeHeap.push_back(item);
+			break;
+		case ScheduledSpawnState::UpcomingByDistance:
+			upcomingByDistance.push_back(item);
+			break;
+		default:
+			upcomingByTime.push_back(item);
+			break;
+		}
+	}
+
+	for (const AircraftState& state : snapshot.aircraft)
+	{
+		if (state.scheduled < 0)
+			continue;
+
+		Entry& entry = entries[static_cast<std::size_t>(state.scheduled)];
+		entry.built.push_back(factory(static_cast<Aircraft::Type>(state.type)));
+		entry.built.back()->loadState(state);
+	}
+}
+
+std::size_t SpawnScheduler::allocate(const SpawnRequest& request, float distance, sf::Time delay, bool anchored)
+{
+	std::size_t index;
+	if (freeEntries.empty())
+	{
+		index = entries.size();
+		entries.emplace_back();
+	}
+	else
+	{
+		index = freeEntries.back();
+		freeEntries.pop_back();
+	}
+
+	Entry& entry = entries[index];
+	entry.request = request;
+	entry.request.count = std::max<std::size_t>(request.count, 1);
+	entry.distance = distance;
+	entry.delay = delay;
+	entry.anchored = anchored;
+	entry.built.clear();
+	return index;
+}
+
+void SpawnScheduler::push(Heap& heap, float key, std::size_t entry)
+{
+	heap.push_back({ key, sequence++, entry });
+	std::push_heap(heap.begin(), heap.end(), laterThan<HeapItem>);
+}
+
+SpawnScheduler::HeapItem SpawnScheduler::pop(Heap& heap)
+{
+	std::pop_heap(heap.begin(), heap.end(), laterThan<HeapItem>);
+	HeapItem item = heap.back();
+	heap.pop_back();
+	return item;
+}
+
+std::size_t SpawnScheduler::build(Entry& entry, std::size_t budget)
+{
+	std::size_t built = 0;
+	while (entry.built.size() < entry.request.count && built < budget)
+	{
+		entry.built.push_back(factory(entry.request.type));
+		built += 1;
+	}
+	return built;
+}
+
+void SpawnScheduler::release(std::size_t index, float distance, std::vector<Spawn>& output)
+{
+	Entry& entry = entries[index];
+	build(entry, entry.request.count);
+
+	// Unanchored spawns appear at the battlefield edge
+	float base = entry.anchored ? entry.distance : distance;
+	for (std::size_t i = 0; i < entry.built.size(); ++i)
+	{
+		sf::Vector2f offset = formationOffset(entry.request, i);
+		// The leader starts the path at the spawn point, the others line up
+		// behind it and reach the path later, so nobody appears on screen
+		float phase = 0.f;
+		if (entry.request.formation == Formation::Trail)
+			phase = -static_cast<float>(i) * entry.request.spacing;
+		output.push_back({ std::move(entry.built[i]), entry.request.x + offset.x, base + offset.y, phase });
+	}
+
+	entry.built.clear();
+	freeEntries.push_back(index);
+}
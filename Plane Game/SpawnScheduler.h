@@ -0,0 +1,113 @@
+#pragma once
+#include "Aircraft.h"
+
+#include <SFML/System/NonCopyable.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+enum class Formation
+{
+	Single,
+	Line,
+	Column,
+	Vee,
+	// One behind the other along the aircraft's flight path
+	Trail,
+	FormationCount
+};
+
+// One group of identical aircraft. x is measured from the centre of the stage.
+struct SpawnRequest
+{
+	Aircraft::Type					type;
+	float							x;
+	Formation						formation;
+	std::size_t						count;
+	float							spacing;
+};
+
+// Holds scheduled spawns in two min-heaps, one keyed by stage distance and
+// one by level time. Polling a tick looks only at the heap tops. Spawns due
+// within a few ticks are constructed early, a few per tick, so a dense
+// wave does not build all its aircraft in the frame it appears.
+class WorldSnapshot;
+
+class SpawnScheduler : private sf::NonCopyable
+{
+public:
+	using Factory = std::function<std::unique_ptr<Aircraft>(Aircraft::Type)>;
+
+	struct Spawn
+	{
+		std::unique_ptr<Aircraft>	aircraft;
+		float						x;
+		float						distance;
+		// Distance along the flight path; negative for the trailing members of a
+		// trail, which start behind the path's first point
+		float						phase;
+	};
+
+public:
+	explicit						SpawnScheduler(Factory factory);
+
+	// Appears at `distance` once the battlefield reaches it. With a delay it
+	// waits that long after the battlefield reaches it, then appears at the edge.
+	void							scheduleAtDistance(const SpawnRequest& request, float distance, sf::Time delay = sf::Time::Zero);
+	// Appears at the battlefield edge once `time` has passed since the level started
+	void							scheduleAtTime(const SpawnRequest& request, sf::Time time);
+
+	// distance is the battlefield edge, speed how fast it advances per second
+	void							update(sf::Time dt, float distance, float speed, std::vector<Spawn>& output);
+
+	std::size_t						getScheduledCount() const;
+
+	// Every scheduled spawn with the aircraft built for it so far
+	void							saveState(WorldSnapshot& snapshot) const;
+	void							loadState(const WorldSnapshot& snapshot);
+
+private:
+	struct Entry
+	{
+		SpawnRequest					request;
+		float							distance;
+		sf::Time						delay;
+		bool							anchored;
+		std::vector<std::unique_ptr<Aircraft>>	built;
+	};
+
+	struct HeapItem
+	{
+		float							key;
+		std::uint64_t					sequence;
+		std::size_t						entry;
+	};
+
+	using Heap = std::vector<HeapItem>;
+
+private:
+	std::size_t						allocate(const SpawnRequest& request, float distance, sf::Time delay, bool anchored);
+	void							push(Heap& heap, float key, std::size_t entry);
+	HeapItem						pop(Heap& heap);
+	std::size_t						build(Entry& entry, std::size_t budget);
+	void							release(std::size_t index, float distance, std::vector<Spawn>& output);
+
+private:
+	Factory							factory;
+	sf::Time						elapsedTime;
+	std::uint64_t					sequence;
+
+	std::vector<Entry>				entries;
+	std::vector<std::size_t>		freeEntries;
+
+	Heap							distanceHeap;
+	Heap							timeHeap;
+
+	// Popped from the heaps within the prebuild horizon, still in key order
+	std::deque<HeapItem>			upcomingByDistance;
+	std::deque<HeapItem>			upcomingByTime;
+};
@@ -31,12 +31,17 @@ State::Context State::getContext()
 	return context;
 }
 
-State::Context::Context(sf::RenderWindow& window, TextureHolder_t& textures, FontHolder_t& fonts, Player& player, MusicPlayer& music, SoundPlayer& sounds)
+State::Context::Context(sf::RenderWindow& window, TextureHolder_t& textures, FontHolder_t& fonts, Player& player, MusicPlayer& music, SoundPlayer& sounds, ThreadPool& workers, ResourceLoader& loader, Profiler& profiler, NetworkSettings& network, const WorldSnapshot* startSnapshot)
 	:window(&window)
 	,textures(&textures)
 	,fonts(&fonts)
 	,player(&player)
 	,music(&music)
 	,sounds(&sounds)
+	,workers(&workers)
+	,loader(&loader)
+	,profiler(&profiler)
+	,network(&network)
+	,startSnapshot(startSnapshot)
 {
 }
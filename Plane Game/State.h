@@ -16,6 +16,11 @@ class StateStack;
 class Player;
 class MusicPlayer;
 class SoundPlayer;
+class ThreadPool;
+class ResourceLoader;
+class Profiler;
+struct NetworkSettings;
+class WorldSnapshot;
 
 class State
 {
@@ -29,7 +34,12 @@ public:
 			FontHolder_t& fonts,
 			Player& player,
 			MusicPlayer& music,
-			SoundPlayer& sounds);
+			SoundPlayer& sounds,
+			ThreadPool& workers,
+			ResourceLoader& loader,
+			Profiler& profiler,
+			NetworkSettings& network,
+			const WorldSnapshot* startSnapshot);
 
 		sf::RenderWindow*	window;
 		TextureHolder_t*	textures;
@@ -37,6 +47,12 @@ public:
 		Player*				player;
 		MusicPlayer*		music;
 		SoundPlayer*		sounds;
+		ThreadPool*			workers;
+		ResourceLoader*		loader;
+		Profiler*			profiler;
+		NetworkSettings*	network;
+		// From --snapshot, the mission starts there; null for a normal start
+		const WorldSnapshot*	startSnapshot;
 	};
 
 							State(StateStack& stack, Context context);
@@ -0,0 +1,207 @@
+#include "StressTest.h"
+#include "Headless.h"
+#include "DataTables.h"
+#include "WorldSnapshot.h"
+#include "Random.h"
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/Window/Event.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+namespace
+{
+	// Same as the window, the view size decides what is on the battlefield
+	const unsigned int ViewWidth = 1280;
+	const unsigned int ViewHeight = 720;
+
+	// Lets collisions and first shots settle before measuring
+	const std::size_t WarmupTicks = 30;
+	const std::size_t MeasuredTicks = 120;
+
+	// Streams of the scenario seed, apart from the ones World draws
+	const std::uint64_t SceneStream = 1000;
+	const std::uint64_t ParticleStream = 1001;
+
+	std::size_t scaled(std::size_t count, float scale)
+	{
+		return static_cast<std::size_t>(std::lround(count * scale));
+	}
+
+	void printRow(std::ostream& out, float scale, std::size_t entities, std::size_t alive, float particles,
+		sf::Time update, sf::Time commands, sf::Time collisions, sf::Time scene, sf::Time particleTime, sf::Time draw)
+	{
+		out << std::setw(6) << scale
+			<< std::setw(9) << entities
+			<< std::setw(7) << alive
+			<< std::setw(10) << particles
+			<< std::setw(10) << update.asMicroseconds()
+			<< std::setw(10) << commands.asMicroseconds()
+			<< std::setw(11) << collisions.asMicroseconds()
+			<< std::setw(8) << scene.asMicroseconds()
+			<< std::setw(11) << particleTime.asMicroseconds()
+			<< std::setw(9) << draw.asMicroseconds()
+			<< std::setw(12) << (entities > 0 ? update.asMicroseconds() * 1000 / static_cast<sf::Int64>(entities) : 0)
+			<< std::endl;
+	}
+}
+
+StressScenario::StressScenario()
+	: enemies(24)
+	, bullets(48)
+	, missiles(4)
+	, pickups(4)
+	, particles(1000)
+	, density(1.f)
+	, seed(1)
+	, scales({ 1.f, 2.f, 5.f, 10.f, 20.f, 50.f, 100.f })
+	, rendered(false)
+{
+}
+
+void generateStressScene(const StressScenario& scenario, float scale, sf::Vector2f viewSize, WorldSnapshot& snapshot)
+{
+	RandomStream random(scenario.seed, SceneStream);
+
+	// Denser scenes use a smaller part of the screen, never more than all of it
+	sf::Vector2f area = viewSize / std::sqrt(std::max(scenario.density, 1.f));
+	sf::Vector2f corner(snapshot.world.viewCenterX - area.x / 2.f, snapshot.world.viewCenterY - area.y / 2.f);
+	// x first, in its own statement; argument order is up to the compiler
+	auto position = [&]()
+	{
+		float x = corner.x + random.nextFloat() * area.x;
+		float y = corner.y + random.nextFloat() * area.y;
+		return sf::Vector2f(x, y);
+	};
+
+	const AircraftTable& aircraftTable = entityTables().aircraft;
+	for (std::size_t i = 0, count = scaled(scenario.enemies, scale); i < count; ++i)
+	{
+		Aircraft::Type type = (i % 2 == 0) ? Aircraft::Type::Raptor : Aircraft::Type::Avenger;
+		const AircraftData& data = aircraftTable[type];
+		sf::Vector2f at = position();
+
+		AircraftState record = {};
+		record.random = random.split();
+		record.fireCountdown = sf::seconds(random.nextFloat() * data.fireInterval.asSeconds()).asMicroseconds();
+		record.type = static_cast<std::int32_t>(type);
+		record.hitpoints = data.hitpoints;
+		record.x = at.x;
+		record.y = at.y;
+		record.rotation = 180.f;
+		// Somewhere along the pattern, so they do not all turn at once
+		record.directionIndex = data.directions.empty() ? 0 : random.nextInt(static_cast<int>(data.directions.size()));
+		if (!data.path.isEmpty())
+			record.travelledDistance = random.nextFloat() * data.path.getLength();
+		record.missileAmmo = 10;
+		record.fireRateLevel = 1;
+		record.spreadLevel = 1;
+		record.showExplosion = 1;
+		record.scheduled = -1;
+		snapshot.aircraft.push_back(record);
+	}
+
+	const ProjectileTable& projectileTable = entityTables().projectiles;
+	for (std::size_t i = 0, count = scaled(scenario.bullets, scale); i < count; ++i)
+	{
+		// Half of them the player's, flying up
+		bool allied = (i % 2 == 0);
+		Projectile::Type type = allied ? Projectile::Type::AlliedBullet : Projectile::Type::EnemyBullet;
+		float speed = projectileTable[type].speed;
+		sf::Vector2f at = position();
+		snapshot.projectiles.push_back({ static_cast<std::int32_t>(type), 1, at.x, at.y, allied ? 0.f : 180.f,
+			0.f, allied ? -speed : speed, 0.f, 0.f });
+	}
+
+	for (std::size_t i = 0, count = scaled(scenario.missiles, scale); i < count; ++i)
+	{
+		float speed = projectileTable[Projectile::Type::Missile].speed;
+		sf::Vector2f at = position();
+		snapshot.projectiles.push_back({ static_cast<std::int32_t>(Projectile::Type::Missile), 1, at.x, at.y, 0.f,
+			0.f, -speed, 0.f, 0.f });
+	}
+
+	for (std::size_t i = 0, count = scaled(scenario.pickups, scale); i < count; ++i)
+	{
+		sf::Vector2f at = position();
+		std::int32_t type = random.nextInt(static_cast<int>(Pickup::Type::TypeCount));
+		snapshot.pickups.push_back({ type, 1, at.x, at.y, 0.f, 0.f });
+	}
+}
+
+int runStressTest(const StressScenario& scenario)
+{
+	std::unique_ptr<sf::RenderWindow> window;
+	if (scenario.rendered)
+	{
+		window.reset(new sf::RenderWindow(sf::VideoMode(ViewWidth, ViewHeight), "Stress test"));
+		window->setVerticalSyncEnabled(false);
+	}
+
+	std::cout << "Stress test, seed " << scenario.seed << ", density " << scenario.density
+		<< (scenario.rendered ? ", rendered" : ", headless") << ". Times are per tick in us,\n"
+		<< "averaged over " << MeasuredTicks << " ticks after " << WarmupTicks << " of warmup. "
+		<< "A rising last column means update does not scale linearly.\n";
+	std::cout << " scale entities  alive particles    update  commands collisions   scene  particles     draw  ns/entity" << std::endl;
+
+	for (float scale : scenario.scales)
+	{
+		// A fresh World each time, nothing carries over between points
+		HeadlessWorld headless(window.get());
+		World& world = headless.getWorld();
+		Profiler& profiler = headless.getProfiler();
+		seedRandom(scenario.seed);
+		headless.finishLoading();
+
+		WorldSnapshot snapshot;
+		world.saveSnapshot(snapshot);
+		generateStressScene(scenario, scale, sf::Vector2f(ViewWidth, ViewHeight), snapshot);
+		std::size_t entities = snapshot.aircraft.size() + snapshot.projectiles.size() + snapshot.pickups.size();
+		world.restoreSnapshot(snapshot);
+
+		RandomStream random(scenario.seed, ParticleStream);
+		sf::Vector2f center(snapshot.world.viewCenterX, snapshot.world.viewCenterY);
+		for (std::size_t i = 0, count = scaled(scenario.particles, scale); i < count; ++i)
+		{
+			float x = (random.nextFloat() - 0.5f) * ViewWidth;
+			float y = (random.nextFloat() - 0.5f) * ViewHeight;
+			sf::Vector2f offset(x, y);
+			world.addParticle(i % 4 == 0 ? Particle::Type::Propellant : Particle::Type::Smoke, center + offset);
+		}
+
+		for (std::size_t tick = 0; tick < WarmupTicks; ++tick)
+			world.update(HeadlessWorld::TimePerFrame);
+		profiler.flushReport();
+
+		sf::Time updateTime;
+		sf::Time drawTime;
+		sf::Clock clock;
+		for (std::size_t tick = 0; tick < MeasuredTicks; ++tick)
+		{
+			clock.restart();
+			world.update(HeadlessWorld::TimePerFrame);
+			updateTime += clock.restart();
+			world.draw();
+			headless.display();
+			drawTime += clock.restart();
+
+			// Keeps the window responsive, it cannot be closed mid run
+			sf::Event event;
+			while (window && window->pollEvent(event))
+			{
+			}
+		}
+
+		world.saveSnapshot(snapshot);
+		std::size_t alive = snapshot.aircraft.size() + snapshot.projectiles.size() + snapshot.pickups.size();
+		const sf::Int64 ticks = static_cast<sf::Int64>(MeasuredTicks);
+		printRow(std::cout, scale, entities, alive, profiler.getValue("Particles"),
+			updateTime / ticks, profiler.getAverage("Update commands"), profiler.getAverage("Update collisions"),
+			profiler.getAverage("Update scene"), profiler.getAverage("Update particle vertices"), drawTime / ticks);
+	}
+	return 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+
+#include <cstdint>
+#include <vector>
+
+class WorldSnapshot;
+
+// A synthetic scene for scaling tests. The counts are for scale 1, about what
+// the level shows at once; every scale multiplies them.
+struct StressScenario
+{
+									StressScenario();
+
+	std::size_t						enemies;
+	std::size_t						bullets;
+	std::size_t						missiles;
+	std::size_t						pickups;
+	std::size_t						particles;
+	// 1 spreads everything over the visible screen, 4 packs it into a quarter
+	float							density;
+	// Same seed, same scene and same simulation
+	std::uint64_t					seed;
+	// One point of the curve each
+	std::vector<float>				scales;
+	// Draws into a window instead of a hidden texture
+	bool							rendered;
+};
+
+// Adds the scenario's aircraft, projectiles and pickups at this scale to a
+// snapshot, around the view centre it records
+void								generateStressScene(const StressScenario& scenario, float scale, sf::Vector2f viewSize, WorldSnapshot& snapshot);
+
+// Builds a fresh World per scale, fills it and prints update and draw times
+// against entity count, run with "--stress". Returns the process exit code.
+int									runStressTest(const StressScenario& scenario);
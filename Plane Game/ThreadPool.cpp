@@ -0,0 +1,58 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+	: workers()
+	, tasks()
+	, mutex()
+	, condition()
+	, stopping(false)
+{
+	for (std::size_t i = 0; i < threadCount; ++i)
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	condition.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+}
+
+std::size_t ThreadPool::getThreadCount() const
+{
+	return workers.size();
+}
+
+std::size_t ThreadPool::defaultThreadCount()
+{
+	// Leave one hardware thread for the main loop
+	std::size_t hardwareThreads = std::thread::hardware_concurrency();
+	return std::max<std::size_t>(hardwareThreads, 2) - 1;
+}
+
+void ThreadPool::workerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+			// Drain remaining work before shutting down
+			if (tasks.empty())
+				return;
+
+			task = std::move(tasks.front());
+			tasks.pop();
+		}
+		task();
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <SFML/System/NonCopyable.hpp>
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool : private sf::NonCopyable
+{
+public:
+	explicit							ThreadPool(std::size_t threadCount = defaultThreadCount());
+										~ThreadPool();
+
+	template <typename Function>
+	auto								enqueue(Function fn) -> std::future<decltype(fn())>;
+
+	std::size_t							getThreadCount() const;
+	static std::size_t					defaultThreadCount();
+
+private:
+	void								workerLoop();
+
+private:
+	std::vector<std::thread>			workers;
+	std::queue<std::function<void()>>	tasks;
+	std::mutex							mutex;
+	std::condition_variable				condition;
+	bool								stopping;
+};
+
+template <typename Function>
+auto ThreadPool::enqueue(Function fn) -> std::future<decltype(fn())>
+{
+	using Result = decltype(fn());
+
+	// packaged_task is move-only, share it so the queue can hold a std::function
+	auto task = std::make_shared<std::packaged_task<Result()>>(std::move(fn));
+	std::future<Result> result = task->get_future();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push([task]() { (*task)(); });
+	}
+	condition.notify_one();
+
+	return result;
+}
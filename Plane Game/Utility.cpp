@@ -3,17 +3,10 @@
 #include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Graphics/Text.hpp>
 #include <cmath>
-#include <random>
+#include <sys/stat.h>
 
 namespace {
 	const float PI = 3.1415927;
-
-	std::mt19937 createRandomEngine()
-	{
-		std::random_device r;
-		return std::mt19937(r());
-	}
-	auto RandomEngine = createRandomEngine();
 }
 
 
@@ -57,8 +50,10 @@ sf::Vector2f normalize(sf::Vector2f v)
 		return v;
 }
 
-int randomInt(int exclusiveMax)
+std::time_t getModificationTime(const std::string& filename)
 {
-	std::uniform_int_distribution<> distribution(0, exclusiveMax - 1);
-	return distribution(RandomEngine);
+	struct stat info;
+	if (stat(filename.c_str(), &info) != 0)
+		return 0;
+	return info.st_mtime;
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include <SFML/System/Vector2.hpp>
+#include <ctime>
+#include <string>
 
 namespace sf
 {
@@ -16,4 +18,6 @@ float			toDegree(float radian);
 float			toRadian(float degree);
 float			length(sf::Vector2f v);
 sf::Vector2f	normalize(sf::Vector2f v);
-int				randomInt(int exclusiveMax);
+
+// 0 when the file does not exist
+std::time_t		getModificationTime(const std::string& filename);
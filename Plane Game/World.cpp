@@ -5,71 +5,191 @@
 #include "ParticleNode.h"
 #include "PostEffect.h"
 #include "SoundNode.h"
+#include "Pickup.h"
+#include "Projectile.h"
+#include "Random.h"
 
-World::World(sf::RenderTarget& outputTarget, FontHolder_t& fonts, SoundPlayer& sounds)
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/System/Clock.hpp>
+
+namespace
+{
+	// Background segments are placed this far above the view before they scroll in
+	const float BackgroundLookahead = 200.f;
+	// Level spawns reach the scheduler this far before the battlefield edge
+	const float SpawnLookahead = 300.f;
+}
+
+World::World(sf::RenderTarget& outputTarget, FontHolder_t& fonts, SoundPlayer& sounds, ThreadPool& workers, ResourceLoader& loader, Profiler& profiler)
 :target(outputTarget)
-,sceneTexture()
 ,worldView(target.getDefaultView())
 ,textures()
 ,fonts(fonts)
 ,sounds(sounds)
+,workers(workers)
+,tableWatcher("Media/Data/Entities.txt", "Media/Data/Entities.bin")
+,loader(loader)
+,profiler(profiler)
+,particleBudget(profiler)
+,movementSystem()
+,registry()
 ,sceneGraph()
 ,sceneLayers()
 ,commandQueue()
-,worldBounds(0.f,0.f, worldView.getSize().x,6000.f) //length of background scroller
+,level(workers, "Media/Levels/Level1.txt", "Media/Levels/Level1.lvl")
+,spawnScheduler([this](Aircraft::Type type) { return std::unique_ptr<Aircraft>(new Aircraft(type, this->textures, this->fonts)); })
+,background(nullptr)
+,backgroundSegments()
+,worldBounds(0.f,0.f, worldView.getSize().x, level.getStageLength())
 ,spawnPosition(worldView.getSize().x / 2.f, worldBounds.height - worldView.getSize().y / 2.f)
+,loaded(false)
+,resimulating(false)
 ,scrollSpeed(-100.f)
-,playerAircraft(nullptr)
+,playerAircrafts()
+,localIdentifier(0)
+,remoteEntities()
+,remoteControlled(false)
+,renderTargets()
+,postEffects(renderTargets, profiler)
+,bloomEffect(loader)
+,softwareBloom(workers)
+,sceneImage()
+,bloomImage()
+,bloomTexture()
 {
-	sceneTexture.create(target.getSize().x, target.getSize().y);
+	postEffects.addEffect(bloomEffect);
 	loadTextures();
-	buildScene();
 	worldView.setCenter(spawnPosition);
+
+	// The scene needs its textures, build it once they are uploaded
+	loader.then([this]()
+	{
+		buildScene();
+		loaded = true;
+	});
 }
 
 void World::update(sf::Time dt)
 {
+	// Per phase timings, so stress runs show which one stops scaling
+	sf::Clock clock;
+
+	// particle jobs from the last tick still read the particle arrays
+	finishParticleVertices();
+	sf::Time particleTime = clock.restart();
+	if (tableWatcher.update(dt))
+		movementSystem.rebuildPatterns();
+
 	// scroll view
 	worldView.move(0.f, scrollSpeed*dt.asSeconds());
 
 	//reset player velocity
-	playerAircraft->setVelocity(0.f, 0.f);
+	for (Aircraft* aircraft : playerAircrafts)
+		aircraft->setVelocity(0.f, 0.f);
 	
 	destroyEntitiesOutsideView();
 	guideMissiles();
+	streamLevel();
 
-	while (!commandQueue.isEmpty()) {
-		sceneGraph.onCommand(commandQueue.pop(), dt);
-	}
+	clock.restart();
+	dispatchCommands(dt);
+	sf::Time commandTime = clock.getElapsedTime();
 	adaptPlayerVelocity();
 	//Remove all destroyed entities, create new ones
+	removeDeadPlayers();
 	sceneGraph.removeWrecks();
 	//Collision detection and response(may destroy entities)
+	clock.restart();
 	handleCollisions();
+	profiler.addSample("Update collisions", clock.getElapsedTime());
 	
 	
-	spawnEnemies();
+	spawnEnemies(dt);
 
+	clock.restart();
+	movementSystem.update(dt);
 	sceneGraph.update(dt,getCommands());
+	profiler.addSample("Update scene", clock.restart());
 	adaptPlayerPosition();
+
+	// Shots, missiles and pickup drops take effect within the tick that made
+	// them, so nothing the simulation owes is left queued between ticks
+	dispatchCommands(dt);
+	commandTime += clock.restart();
+	profiler.addSample("Update commands", commandTime);
+
+	// vertex generation runs on the workers while the rest of the frame proceeds
+	if (!resimulating)
+		prepareParticleVertices();
+	profiler.addSample("Update particle vertices", particleTime + clock.getElapsedTime());
 	updateSounds();
 }
 
+void World::dispatchCommands(sf::Time dt)
+{
+	while (!commandQueue.isEmpty()) {
+		sceneGraph.onCommand(commandQueue.pop(), dt);
+	}
+}
+
+void World::setResimulating(bool resimulating)
+{
+	this->resimulating = resimulating;
+}
+
 void World::draw()
 {
-	if (PostEffect::isSupported()) 
+	finishParticleVertices();
+	// Per frame, not per tick: a slow frame runs several ticks
+	particleBudget.update(profiler.getFrameTime());
+
+	if (PostEffect::isSupported() && postEffects.isActive())
 	{
+		sf::RenderTexture& sceneTexture = renderTargets.acquire(target.getSize());
 		sceneTexture.clear();
 		sceneTexture.setView(worldView);
 		sceneTexture.draw(sceneGraph);
 		sceneTexture.display();
-		bloomEffect.apply(sceneTexture, target);
+		postEffects.apply(sceneTexture, target);
+		renderTargets.release(sceneTexture);
+	}
+	else if (postEffects.isActive())
+	{
+		drawSoftwareBloom();
 	}
 	else 
 	{
 		target.setView(worldView);
 		target.draw(sceneGraph);
 	}
+
+	renderTargets.endFrame();
+}
+
+void World::renderScene(sf::Image& image)
+{
+	sf::RenderTexture& sceneTexture = renderTargets.acquire(target.getSize());
+	sceneTexture.clear();
+	sceneTexture.setView(worldView);
+	sceneTexture.draw(sceneGraph);
+	sceneTexture.display();
+	image = sceneTexture.getTexture().copyToImage();
+	renderTargets.release(sceneTexture);
+}
+
+void World::drawSoftwareBloom()
+{
+	sf::Clock clock;
+	renderScene(sceneImage);
+	softwareBloom.apply(sceneImage, bloomImage);
+
+	if (bloomTexture.getSize() != bloomImage.getSize())
+		bloomTexture.create(bloomImage.getSize().x, bloomImage.getSize().y);
+	bloomTexture.update(bloomImage);
+	profiler.addSample("Bloom (software)", clock.getElapsedTime());
+
+	target.setView(target.getDefaultView());
+	target.draw(sf::Sprite(bloomTexture));
 }
 
 CommandQueue& World::getCommands()
@@ -77,34 +197,329 @@ CommandQueue& World::getCommands()
 	return commandQueue;
 }
 
+bool World::isLoaded() const
+{
+	return loaded;
+}
+
+void World::setBloomQuality(BloomEffect::Quality quality)
+{
+	bloomEffect.setQuality(quality);
+}
+
+BloomEffect::Quality World::getBloomQuality() const
+{
+	return bloomEffect.getQuality();
+}
+
+void World::capture(sf::Image& image)
+{
+	finishParticleVertices();
+	renderScene(sceneImage);
+
+	// Captures always go through the CPU bloom so they look the same on every machine
+	if (bloomEffect.isEnabled())
+		softwareBloom.apply(sceneImage, image);
+	else
+		image = sceneImage;
+}
+
 bool World::hasAlivePlayer() const
 {
-	return !playerAircraft->isMarkedForRemoval();
+	return !playerAircrafts.empty();
 }
 
 bool World::hasPlayerReachedEnd() const
 {
-	return !worldBounds.contains(playerAircraft->getPosition());
+	for (Aircraft* aircraft : playerAircrafts)
+	{
+		if (!worldBounds.contains(aircraft->getPosition()))
+			return true;
+	}
+	return false;
+}
+
+Aircraft* World::addAircraft(int identifier)
+{
+	// Side by side, whoever joins later appears next to the others
+	std::unique_ptr<Aircraft> player(new Aircraft(Aircraft::Type::Eagle, textures, fonts));
+	player->setIdentifier(identifier);
+	player->setPosition(worldView.getCenter().x + 80.f * identifier, worldView.getCenter().y);
+	player->setVelocity(80.f, scrollSpeed);
+	playerAircrafts.push_back(player.get());
+	sceneLayers[UpperAir]->attachChild(std::move(player));
+	return playerAircrafts.back();
+}
+
+Aircraft* World::getAircraft(int identifier) const
+{
+	for (Aircraft* aircraft : playerAircrafts)
+	{
+		if (aircraft->getIdentifier() == identifier)
+			return aircraft;
+	}
+	return nullptr;
+}
+
+void World::removeAircraft(int identifier)
+{
+	Aircraft* aircraft = getAircraft(identifier);
+	if (!aircraft)
+		return;
+
+	// Left the game, no explosion and no pickup
+	playerAircrafts.erase(std::find(playerAircrafts.begin(), playerAircrafts.end(), aircraft));
+	sceneLayers[UpperAir]->detachChild(*aircraft);
+}
+
+void World::captureNetworkState(NetworkState& state, std::uint32_t tick)
+{
+	state.tick = tick;
+	state.viewY = quantizePosition(worldView.getCenter().y);
+	state.entities.clear();
+
+	auto addEntity = [&state](const Entity& entity, NetworkEntity::Kind kind, int type, int owner)
+	{
+		NetworkEntity record;
+		record.id = entity.getNetworkId();
+		record.kind = kind;
+		record.type = static_cast<std::uint8_t>(type);
+		record.owner = static_cast<std::uint8_t>(owner);
+		record.rotation = quantizeRotation(entity.getRotation());
+		record.x = quantizePosition(entity.getPosition().x);
+		record.y = quantizePosition(entity.getPosition().y);
+		record.vx = quantizePosition(entity.getVelocity().x);
+		record.vy = quantizePosition(entity.getVelocity().y);
+		record.hitpoints = entity.getHitpoints();
+		state.entities.push_back(record);
+	};
+
+	Command aircraftCollector;
+	aircraftCollector.category = Category::Aircraft;
+	aircraftCollector.action = derivedAction<Aircraft>([&addEntity](Aircraft& aircraft, sf::Time)
+	{
+		addEntity(aircraft, NetworkEntity::Aircraft, static_cast<int>(aircraft.getType()), aircraft.getIdentifier());
+	});
+	Command projectileCollector;
+	projectileCollector.category = Category::Projectile;
+	projectileCollector.action = derivedAction<Projectile>([&addEntity](Projectile& projectile, sf::Time)
+	{
+		addEntity(projectile, NetworkEntity::Projectile, static_cast<int>(projectile.getType()), 0);
+	});
+	Command pickupCollector;
+	pickupCollector.category = Category::Pickup;
+	pickupCollector.action = derivedAction<Pickup>([&addEntity](Pickup& pickup, sf::Time)
+	{
+		addEntity(pickup, NetworkEntity::Pickup, static_cast<int>(pickup.getType()), 0);
+	});
+
+	sceneGraph.onCommand(aircraftCollector, sf::Time::Zero);
+	sceneGraph.onCommand(projectileCollector, sf::Time::Zero);
+	sceneGraph.onCommand(pickupCollector, sf::Time::Zero);
+
+	std::sort(state.entities.begin(), state.entities.end(), [](const NetworkEntity& a, const NetworkEntity& b)
+	{
+		return a.id < b.id;
+	});
+}
+
+void World::applyNetworkState(const NetworkState& state, int localIdentifier)
+{
+	finishParticleVertices();
+	this->localIdentifier = localIdentifier;
+
+	// The first state replaces whatever the client built on its own
+	if (!remoteControlled)
+	{
+		while (!commandQueue.isEmpty())
+			commandQueue.pop();
+		sceneLayers[UpperAir]->removeChildren(Category::Aircraft);
+		sceneLayers[LowerAir]->removeChildren(Category::Projectile | Category::Pickup);
+		remoteControlled = true;
+	}
+
+	worldView.setCenter(worldView.getCenter().x, dequantizePosition(state.viewY));
+
+	std::map<std::uint32_t, Entity*> previous;
+	previous.swap(remoteEntities);
+	playerAircrafts.clear();
+
+	for (const NetworkEntity& record : state.entities)
+	{
+		Entity* entity = nullptr;
+		auto found = previous.find(record.id);
+		if (found != previous.end())
+		{
+			entity = found->second;
+			previous.erase(found);
+		}
+		else
+		{
+			entity = createRemoteEntity(record);
+			if (!entity)
+				continue;
+		}
+		remoteEntities[record.id] = entity;
+
+		entity->setPosition(dequantizePosition(record.x), dequantizePosition(record.y));
+		entity->setVelocity(dequantizePosition(record.vx), dequantizePosition(record.vy));
+		entity->setRotation(dequantizeRotation(record.rotation));
+		entity->setHitpoints(record.hitpoints);
+
+		if (entity->getCategory() == Category::PlayerAircraft)
+			playerAircrafts.push_back(static_cast<Aircraft*>(entity));
+	}
+
+	// Whatever the host no longer sends is gone
+	for (auto& pair : previous)
+	{
+		Layer layer = (pair.second->getCategory() & Category::Aircraft) ? UpperAir : LowerAir;
+		sceneLayers[layer]->detachChild(*pair.second);
+	}
+}
+
+void World::updateRemote(sf::Time dt)
+{
+	finishParticleVertices();
+
+	worldView.move(0.f, scrollSpeed * dt.asSeconds());
+	streamLevel();
+
+	for (auto& pair : remoteEntities)
+	{
+		Entity& entity = *pair.second;
+		entity.move(entity.getVelocity() * dt.asSeconds());
+		if (entity.getCategory() & Category::Aircraft)
+			static_cast<Aircraft&>(entity).updateRemote(dt);
+	}
+
+	prepareParticleVertices();
+	updateSounds();
+}
+
+void World::saveSnapshot(WorldSnapshot& snapshot)
+{
+	snapshot.clear();
+
+	WorldState& state = snapshot.world;
+	state.randomSeed = getRandomSeed();
+	state.randomStreams = getRandomStreamCount();
+	level.getCursors(state.levelCursors);
+	state.viewCenterX = worldView.getCenter().x;
+	state.viewCenterY = worldView.getCenter().y;
+	state.scrollSpeed = scrollSpeed;
+	state.padding = 0;
+
+	spawnScheduler.saveState(snapshot);
+
+	for (const BackgroundSegment& segment : backgroundSegments)
+		snapshot.segments.push_back({ static_cast<std::int32_t>(segment.texture), segment.distance, segment.length, segment.blend });
+
+	// Visited in scene order, which restore keeps
+	Command aircraftSaver;
+	aircraftSaver.category = Category::Aircraft;
+	aircraftSaver.action = derivedAction<Aircraft>([&snapshot](Aircraft& aircraft, sf::Time)
+	{
+		snapshot.aircraft.push_back(aircraft.saveState());
+	});
+	Command projectileSaver;
+	projectileSaver.category = Category::Projectile;
+	projectileSaver.action = derivedAction<Projectile>([&snapshot](Projectile& projectile, sf::Time)
+	{
+		snapshot.projectiles.push_back(projectile.saveState());
+	});
+	Command pickupSaver;
+	pickupSaver.category = Category::Pickup;
+	pickupSaver.action = derivedAction<Pickup>([&snapshot](Pickup& pickup, sf::Time)
+	{
+		snapshot.pickups.push_back(pickup.saveState());
+	});
+
+	sceneGraph.onCommand(aircraftSaver, sf::Time::Zero);
+	sceneGraph.onCommand(projectileSaver, sf::Time::Zero);
+	sceneGraph.onCommand(pickupSaver, sf::Time::Zero);
+}
+
+void World::addParticle(Particle::Type type, sf::Vector2f position)
+{
+	if (ParticleNode* system = registry.getParticleSystem(type))
+		system->addParticle(position);
+}
+
+void World::restoreSnapshot(const WorldSnapshot& snapshot)
+{
+	// Particle jobs may still read the nodes about to go
+	finishParticleVertices();
+	while (!commandQueue.isEmpty())
+		commandQueue.pop();
+
+	sceneLayers[UpperAir]->removeChildren(Category::Aircraft);
+	sceneLayers[LowerAir]->removeChildren(Category::Projectile | Category::Pickup);
+	playerAircrafts.clear();
+
+	const WorldState& state = snapshot.world;
+	worldView.setCenter(state.viewCenterX, state.viewCenterY);
+	scrollSpeed = state.scrollSpeed;
+	level.seek(state.levelCursors);
+	spawnScheduler.loadState(snapshot);
+
+	background->clearSegments();
+	backgroundSegments.clear();
+	for (const BackgroundSegmentState& segment : snapshot.segments)
+		addBackgroundSegment({ static_cast<TextureID>(segment.texture), segment.distance, segment.length, segment.blend });
+
+	for (const AircraftState& record : snapshot.aircraft)
+	{
+		if (record.scheduled >= 0)
+			continue;
+
+		std::unique_ptr<Aircraft> aircraft(new Aircraft(static_cast<Aircraft::Type>(record.type), textures, fonts));
+		aircraft->loadState(record);
+		if (aircraft->getCategory() == Category::PlayerAircraft)
+			playerAircrafts.push_back(aircraft.get());
+		sceneLayers[UpperAir]->attachChild(std::move(aircraft));
+	}
+
+	for (const ProjectileState& record : snapshot.projectiles)
+	{
+		std::unique_ptr<Projectile> projectile(new Projectile(static_cast<Projectile::Type>(record.type), textures));
+		projectile->loadState(record);
+		sceneLayers[LowerAir]->attachChild(std::move(projectile));
+	}
+
+	for (const PickupState& record : snapshot.pickups)
+	{
+		std::unique_ptr<Pickup> pickup(new Pickup(static_cast<Pickup::Type>(record.type), textures));
+		pickup->loadState(record);
+		sceneLayers[LowerAir]->attachChild(std::move(pickup));
+	}
+
+	// Last, the aircraft built above drew streams of their own
+	restoreRandom(state.randomSeed, state.randomStreams);
 }
 
 void World::loadTextures()
 {
 
-	textures.load(TextureID::Desert, "Media/Textures/Desert.png");
-	textures.load(TextureID::Jungle, "Media/Textures/Jungle.png");
+	textures.loadAsync(TextureID::Desert, "Media/Textures/Desert.png", loader);
+	textures.loadAsync(TextureID::Jungle, "Media/Textures/Jungle.png", loader);
 
-	textures.load(TextureID::Explosion, "Media/Textures/Explosion.png");
-	textures.load(TextureID::Particle, "Media/Textures/Particle.png");
+	textures.loadAsync(TextureID::Explosion, "Media/Textures/Explosion.png", loader);
+	textures.loadAsync(TextureID::Particle, "Media/Textures/Particle.png", loader);
 
-	textures.load(TextureID::FinishLine, "Media/Textures/FinishLine.png");
+	textures.loadAsync(TextureID::FinishLine, "Media/Textures/FinishLine.png", loader);
 
-	textures.load(TextureID::Entities, "Media/Textures/Entities.png");
+	textures.loadAsync(TextureID::Entities, "Media/Textures/Entities.png", loader);
 
 
 }
 
 void World::buildScene()
 {
+	// nodes attached below resolve shared systems through the registry
+	registry.registerMovementSystem(movementSystem);
+	sceneGraph.setRegistry(&registry);
+
 	for (std::size_t i = 0; i < LayerCount; ++i) {
 
 		Category::Type category =
@@ -120,18 +535,10 @@ void World::buildScene()
 	std::unique_ptr<SoundNode> soundNode(new SoundNode(sounds));
 	sceneGraph.attachChild(std::move(soundNode));
 
-	//prepare background texture
-	sf::Texture& texture = textures.get(TextureID::Jungle);
-	texture.setRepeated(true);
-
-	float viewHeight = worldView.getSize().y;
-	sf::IntRect textureRect(worldBounds);
-	textureRect.height += static_cast<int>(viewHeight);
-
-	//background spriteNode
-	std::unique_ptr<SpriteNode> jungle(new SpriteNode(texture,textureRect));
-	jungle->setPosition(worldBounds.left, worldBounds.top-viewHeight);
-	sceneLayers[Background]->attachChild(std::move(jungle));
+	//background tiles, segments stream in from the level
+	std::unique_ptr<BackgroundNode> backgroundNode(new BackgroundNode(worldBounds.width));
+	background = backgroundNode.get();
+	sceneLayers[Background]->attachChild(std::move(backgroundNode));
 
 	//finish line
 	sf::Texture& finishTexture = textures.get(TextureID::FinishLine);
@@ -140,97 +547,121 @@ void World::buildScene()
 	sceneLayers[Background]->attachChild(std::move(finishSprite));
 
 	// add particle systems
-	std::unique_ptr<ParticleNode> smokeNode(new ParticleNode(Particle::Type::Smoke, textures));
+	std::unique_ptr<ParticleNode> smokeNode(new ParticleNode(Particle::Type::Smoke, textures, particleBudget));
 	sceneLayers[LowerAir]->attachChild(std::move(smokeNode));
 
-	std::unique_ptr<ParticleNode> propellantNode(new ParticleNode(Particle::Type::Propellant, textures));
+	std::unique_ptr<ParticleNode> propellantNode(new ParticleNode(Particle::Type::Propellant, textures, particleBudget));
 	sceneLayers[LowerAir]->attachChild(std::move(propellantNode));
 
 	
 
 
-	//add player aircraft
-	std::unique_ptr<Aircraft> leader(new Aircraft(Aircraft::Type::Eagle, textures, fonts));
-	playerAircraft = leader.get();
-	playerAircraft->setPosition(spawnPosition);
-	playerAircraft->setVelocity(80.f, scrollSpeed);
-	sceneLayers[UpperAir]->attachChild(std::move(leader));
+	//add player aircraft, a co-op partner joins later
+	addAircraft(0);
 
-	addEnemies();
+	streamLevel();
 
 }
 
-void World::addEnemies()
+void World::streamLevel()
 {
-	// Add enemies to the spawn point container
-	addEnemy(Aircraft::Type::Raptor, 0.f, 1500.f);
-	addEnemy(Aircraft::Type::Raptor, -170.f, 1500.f);
-	addEnemy(Aircraft::Type::Raptor, 170.f, 1500.f);
-
-	addEnemy(Aircraft::Type::Raptor, 0.f, 1000.f);
-	addEnemy(Aircraft::Type::Raptor, -170.f, 500.f);
-	addEnemy(Aircraft::Type::Raptor, 170.f, 1000.f);
-	addEnemy(Aircraft::Type::Raptor, +100.f, 1100.f);
-	addEnemy(Aircraft::Type::Raptor, -100.f, 1100.f);
-
-	addEnemy(Aircraft::Type::Avenger, -70.f, 1400.f);
-	addEnemy(Aircraft::Type::Avenger, -70.f, 1600.f);
-	addEnemy(Aircraft::Type::Avenger, 70.f, 1400.f);
-	addEnemy(Aircraft::Type::Avenger, 70.f, 1600.f);
+	sf::FloatRect viewBounds = getViewBounds();
+	float camera = toDistance(viewBounds.top + viewBounds.height);
+	float lookahead = toDistance(viewBounds.top) + BackgroundLookahead;
 
-	addEnemy(Aircraft::Type::Raptor, 0.f, 2500.f);
-	addEnemy(Aircraft::Type::Raptor, 0.f, 3000.f);
+	level.update(camera, lookahead);
+	addBackgroundSegments(lookahead);
+	removeBackgroundSegments(camera);
+	applyTriggers(camera);
 
-	addEnemy(Aircraft::Type::Raptor, +100.f, 4100.f);
-	addEnemy(Aircraft::Type::Raptor, -100.f, 4100.f);
+	profiler.setValue("Level chunks", static_cast<float>(level.getResidentChunkCount()));
+}
 
-	addEnemy(Aircraft::Type::Avenger, -70.f, 4400.f);
-	addEnemy(Aircraft::Type::Avenger, -70.f, 4600.f);
+void World::addBackgroundSegments(float lookahead)
+{
+	std::vector<BackgroundSegment> segments;
+	level.popSegments(lookahead, segments);
 
-	addEnemy(Aircraft::Type::Avenger, -170.f, 5400.f);
-	addEnemy(Aircraft::Type::Avenger, 0.f, 5400.f);
-	addEnemy(Aircraft::Type::Avenger, 170.f, 5400.f);
+	for (const BackgroundSegment& segment : segments)
+		addBackgroundSegment(segment);
+}
 
-	addEnemy(Aircraft::Type::Avenger, -170.f, 5600.f);
-	addEnemy(Aircraft::Type::Avenger, 0.f, 5600.f);
-	addEnemy(Aircraft::Type::Avenger, 170.f, 5600.f);
+void World::addBackgroundSegment(const BackgroundSegment& segment)
+{
+	float bottom = worldBounds.top + worldBounds.height - segment.distance;
+	background->addSegment(textures.get(segment.texture), bottom - segment.length, bottom, segment.blend);
+	backgroundSegments.push_back(segment);
+}
 
-	std::sort(enemySpawnPoints.begin(), enemySpawnPoints.end(),
-		[](SpawnPoint lhs,SpawnPoint rhs) {
-			return lhs.y < rhs.y;
-		});
+void World::removeBackgroundSegments(float camera)
+{
+	background->removeSegmentsBelow(worldBounds.top + worldBounds.height - camera);
+	while (backgroundSegments.size() > background->getSegmentCount())
+		backgroundSegments.pop_front();
 }
 
-void World::addEnemy(Aircraft::Type type, float relX, float relY)
+void World::applyTriggers(float camera)
 {
-	SpawnPoint spawn(type, spawnPosition.x+relX, spawnPosition.y-relY);
-	enemySpawnPoints.push_back(spawn);
+	std::vector<LevelTrigger> triggers;
+	level.popTriggers(camera, triggers);
+
+	for (const LevelTrigger& trigger : triggers)
+	{
+		switch (trigger.type)
+		{
+		case LevelTrigger::Type::ScrollSpeed:
+			scrollSpeed = -trigger.value;
+			break;
+		default:
+			break;
+		}
+	}
 }
 
-void World::spawnEnemies()
+void World::spawnEnemies(sf::Time dt)
 {
-	while (!enemySpawnPoints.empty() &&
-		enemySpawnPoints.back().y > getBattlefieldBounds().top)
+	float battlefield = toDistance(getBattlefieldBounds().top);
+
+	// handed over early so the scheduler can construct them ahead of time
+	std::vector<SpawnEvent> events;
+	level.popSpawns(battlefield + SpawnLookahead, events);
+	for (const SpawnEvent& event : events)
 	{
-		auto& spawn = enemySpawnPoints.back();
+		if (event.timed)
+			spawnScheduler.scheduleAtTime(event.request, sf::seconds(event.delay));
+		else
+			spawnScheduler.scheduleAtDistance(event.request, event.distance, sf::seconds(event.delay));
+	}
+
+	std::vector<SpawnScheduler::Spawn> spawns;
+	spawnScheduler.update(dt, battlefield, -scrollSpeed, spawns);
 
-		std::unique_ptr<Aircraft> enemy(new Aircraft(spawn.type, textures, fonts));
-		enemy->setPosition(spawn.x, spawn.y);
-		enemy->setRotation(180.f);
-		sceneLayers[UpperAir]->attachChild(std::move(enemy));
-		// Enemy is spawned, remove from the list to spawn
-		enemySpawnPoints.pop_back();
+	for (SpawnScheduler::Spawn& spawn : spawns)
+	{
+		spawn.aircraft->setPosition(spawnPosition.x + spawn.x, worldBounds.top + worldBounds.height - spawn.distance);
+		spawn.aircraft->setRotation(180.f);
+		spawn.aircraft->placeOnPath(spawn.phase);
+		sceneLayers[UpperAir]->attachChild(std::move(spawn.aircraft));
 	}
+	profiler.setValue("Scheduled spawns", static_cast<float>(spawnScheduler.getScheduledCount()));
+}
+
+float World::toDistance(float y) const
+{
+	return worldBounds.top + worldBounds.height - y;
 }
 
 void World::adaptPlayerVelocity()
 {
-	sf::Vector2f velocity = playerAircraft->getVelocity();
-	// If moving diagonally, normalize the velocity
-	if (velocity.x != 0.f && velocity.y != 0.f)
-		playerAircraft->setVelocity(velocity / std::sqrt(2.f));
-	// Add scrolling velocity
-	playerAircraft->accelerate(0.f, scrollSpeed);
+	for (Aircraft* aircraft : playerAircrafts)
+	{
+		sf::Vector2f velocity = aircraft->getVelocity();
+		// If moving diagonally, normalize the velocity
+		if (velocity.x != 0.f && velocity.y != 0.f)
+			aircraft->setVelocity(velocity / std::sqrt(2.f));
+		// Add scrolling velocity
+		aircraft->accelerate(0.f, scrollSpeed);
+	}
 }
 
 void World::adaptPlayerPosition()
@@ -239,18 +670,101 @@ void World::adaptPlayerPosition()
 	sf::FloatRect viewBounds = getViewBounds();
 	const float borderDistance = 40.f;
 
-	sf::Vector2f position = playerAircraft->getPosition();
-	position.x = std::max(position.x, viewBounds.left + borderDistance);
-	position.x = std::min(position.x, viewBounds.left + viewBounds.width - borderDistance);
-	position.y = std::max(position.y, viewBounds.top + borderDistance);
-	position.y = std::min(position.y, viewBounds.top + viewBounds.height - borderDistance);
-	playerAircraft->setPosition(position);
+	for (Aircraft* aircraft : playerAircrafts)
+	{
+		sf::Vector2f position = aircraft->getPosition();
+		position.x = std::max(position.x, viewBounds.left + borderDistance);
+		position.x = std::min(position.x, viewBounds.left + viewBounds.width - borderDistance);
+		position.y = std::max(position.y, viewBounds.top + borderDistance);
+		position.y = std::min(position.y, viewBounds.top + viewBounds.height - borderDistance);
+		aircraft->setPosition(position);
+	}
+}
+
+void World::removeDeadPlayers()
+{
+	// Before removeWrecks destroys them
+	auto dead = std::remove_if(playerAircrafts.begin(), playerAircrafts.end(), [](Aircraft* aircraft)
+	{
+		return aircraft->isMarkedForRemoval();
+	});
+	playerAircrafts.erase(dead, playerAircrafts.end());
+}
+
+Entity* World::createRemoteEntity(const NetworkEntity& record)
+{
+	switch (record.kind)
+	{
+	case NetworkEntity::Aircraft:
+	{
+		if (record.type >= static_cast<std::uint8_t>(Aircraft::Type::TypeCount))
+			return nullptr;
+		std::unique_ptr<Aircraft> aircraft(new Aircraft(static_cast<Aircraft::Type>(record.type), textures, fonts));
+		aircraft->setIdentifier(record.owner);
+		Entity* entity = aircraft.get();
+		sceneLayers[UpperAir]->attachChild(std::move(aircraft));
+		return entity;
+	}
+	case NetworkEntity::Projectile:
+	{
+		if (record.type >= static_cast<std::uint8_t>(Projectile::Type::Count))
+			return nullptr;
+		std::unique_ptr<Projectile> projectile(new Projectile(static_cast<Projectile::Type>(record.type), textures));
+		Entity* entity = projectile.get();
+		sceneLayers[LowerAir]->attachChild(std::move(projectile));
+		return entity;
+	}
+	case NetworkEntity::Pickup:
+	{
+		if (record.type >= Pickup::TypeCount)
+			return nullptr;
+		std::unique_ptr<Pickup> pickup(new Pickup(static_cast<Pickup::Type>(record.type), textures));
+		Entity* entity = pickup.get();
+		sceneLayers[LowerAir]->attachChild(std::move(pickup));
+		return entity;
+	}
+	default:
+		return nullptr;
+	}
 }
 
 void World::updateSounds()
 {
-	sounds.setListenerPosition(playerAircraft->getWorldPosition());
-	sounds.removeStoppedSounds();
+	if (resimulating)
+	{
+		// Already heard the first time round
+		if (SoundNode* soundNode = registry.getSoundNode())
+			soundNode->discard();
+		return;
+	}
+
+	// Follows this machine's player, or whoever is left
+	Aircraft* listener = getAircraft(localIdentifier);
+	if (!listener && !playerAircrafts.empty())
+		listener = playerAircrafts.front();
+	if (listener)
+		sounds.setListenerPosition(listener->getWorldPosition());
+	if (SoundNode* soundNode = registry.getSoundNode())
+		soundNode->dispatch();
+	sounds.update();
+}
+
+void World::prepareParticleVertices()
+{
+	for (ParticleNode* system : registry.getParticleSystems())
+	{
+		if (system)
+			system->prepareVertices(workers);
+	}
+}
+
+void World::finishParticleVertices()
+{
+	for (ParticleNode* system : registry.getParticleSystems())
+	{
+		if (system)
+			system->finishVertices();
+	}
 }
 
 sf::FloatRect World::getViewBounds() const
@@ -363,7 +877,7 @@ void World::handleCollisions()
 			// Apply pickup effect to player, destroy projectile
 			pickup.apply(player);
 			pickup.destroy();
-			player.playLocalSound(commandQueue, EffectID::CollectPickup);
+			player.playLocalSound(EffectID::CollectPickup);
 		}
 
 		else if (matchesCategories(pair, Category::EnemyAircraft, Category::AlliedProjectile)
@@ -4,18 +4,35 @@
 #include "ResourceIdentifier.h"
 #include "SceneNode.h"
 #include "SpriteNode.h"
+#include "BackgroundNode.h"
 #include "Aircraft.h"
 #include "CommandQueue.h"
 #include "Command.h"
 #include "BloomEffect.h"
+#include "RenderTexturePool.h"
+#include "PostEffectChain.h"
+#include "SoftwareBloom.h"
 #include "SoundPlayer.h"
+#include "ThreadPool.h"
+#include "ParticleBudget.h"
+#include "Profiler.h"
+#include "SceneRegistry.h"
+#include "MovementSystem.h"
+#include "DataTableWatcher.h"
+#include "LevelStream.h"
+#include "SpawnScheduler.h"
+#include "WorldSnapshot.h"
+#include "NetworkState.h"
 
 #include <SFML/System/NonCopyable.hpp>
 #include <SFML/Graphics/View.hpp>
 #include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Image.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 
 #include <array>
+#include <deque>
+#include <map>
 
 // Forward declaration
 namespace sf
@@ -26,27 +43,67 @@ namespace sf
 class World : private sf::NonCopyable
 {
 public:
-	explicit							World(sf::RenderTarget& outputTarget,FontHolder_t& fonts, SoundPlayer& sounds);
+	explicit							World(sf::RenderTarget& outputTarget,FontHolder_t& fonts, SoundPlayer& sounds, ThreadPool& workers, ResourceLoader& loader, Profiler& profiler);
 	void								update(sf::Time dt);
 	void								draw();
+	// Rollback: ticks simulated again play no sounds and build no particle vertices
+	void								setResimulating(bool resimulating);
 
 	CommandQueue&						getCommands();
+	bool								isLoaded() const;
+
+	void								setBloomQuality(BloomEffect::Quality quality);
+	BloomEffect::Quality				getBloomQuality() const;
+	void								capture(sf::Image& image);
 
 	bool								hasAlivePlayer() const;
 	bool								hasPlayerReachedEnd() const;
 
+	// One Eagle per player, the host flies identifier 0
+	Aircraft*							addAircraft(int identifier);
+	Aircraft*							getAircraft(int identifier) const;
+	void								removeAircraft(int identifier);
+
+	// Co-op host, between ticks
+	void								captureNetworkState(NetworkState& state, std::uint32_t tick);
+	// Co-op client: the host's state replaces the local simulation, updateRemote
+	// then only extrapolates and animates until the next state arrives
+	void								applyNetworkState(const NetworkState& state, int localIdentifier);
+	void								updateRemote(sf::Time dt);
+
+	// Between ticks only. Each tick runs the commands it issues, so the queue
+	// can only hold input for the next tick, which a restore drops.
+	void								saveSnapshot(WorldSnapshot& snapshot);
+	void								restoreSnapshot(const WorldSnapshot& snapshot);
+
+	// For tools that fill the scene, like stress runs; subject to the particle budget
+	void								addParticle(Particle::Type type, sf::Vector2f position);
+
 private:
 	void								loadTextures();
 	void								buildScene();
 
-	void								addEnemies();
-	void								addEnemy(Aircraft::Type type, float relX, float relY);
-	void								spawnEnemies();
+	void								streamLevel();
+	void								addBackgroundSegments(float lookahead);
+	void								addBackgroundSegment(const BackgroundSegment& segment);
+	void								removeBackgroundSegments(float camera);
+	void								applyTriggers(float camera);
+	void								spawnEnemies(sf::Time dt);
+	void								dispatchCommands(sf::Time dt);
+	float								toDistance(float y) const;
 
 	void								adaptPlayerVelocity();
 	void								adaptPlayerPosition();
+	void								removeDeadPlayers();
+
+	Entity*								createRemoteEntity(const NetworkEntity& record);
 
 	void								updateSounds();
+	void								prepareParticleVertices();
+	void								finishParticleVertices();
+
+	void								renderScene(sf::Image& image);
+	void								drawSoftwareBloom();
 
 	sf::FloatRect						getViewBounds() const;
 	sf::FloatRect						getBattlefieldBounds() const;
@@ -65,34 +122,54 @@ private:
 		LayerCount
 	};
 
-	struct SpawnPoint {
-		SpawnPoint(Aircraft::Type type, float x, float y)
-			:type(type), x(x), y(y) {}
-		Aircraft::Type type;
-		float x, y;
-	};
-
 private:
 	sf::RenderTarget&					target;
-	sf::RenderTexture					sceneTexture;
 	sf::View							worldView;
 	TextureHolder_t						textures;
 	const FontHolder_t&					fonts;
 	SoundPlayer&						sounds;
-
+	ThreadPool&							workers;
+	DataTableWatcher					tableWatcher;
+	ResourceLoader&						loader;
+	Profiler&							profiler;
+	ParticleBudget						particleBudget;
+
+	// Before the scene graph, the aircraft hand back their slots on destruction
+	MovementSystem						movementSystem;
+	SceneRegistry						registry;
 	SceneNode							sceneGraph;
 	std::array<SceneNode*, LayerCount>	sceneLayers;
 	CommandQueue						commandQueue;
 
+	LevelStream							level;
+	SpawnScheduler						spawnScheduler;
+	BackgroundNode*						background;
+	// Mirrors the background's segments, for snapshots
+	std::deque<BackgroundSegment>		backgroundSegments;
+
 	sf::FloatRect						worldBounds;
 	sf::Vector2f						spawnPosition;
+	bool								loaded;
+	bool								resimulating;
 
 	float								scrollSpeed;
-	Aircraft*							playerAircraft;
+	std::vector<Aircraft*>				playerAircrafts;
+	int									localIdentifier;
+
+	// Co-op client, the entities the host sent by network id
+	std::map<std::uint32_t, Entity*>	remoteEntities;
+	bool								remoteControlled;
 
-	std::vector<SpawnPoint>				enemySpawnPoints;
 	std::vector<Aircraft*>				activeEnemies;
 	
+	RenderTexturePool					renderTargets;
+	PostEffectChain						postEffects;
 	BloomEffect							bloomEffect;
+
+	// Used when the target has no shader support
+	SoftwareBloom						softwareBloom;
+	sf::Image							sceneImage;
+	sf::Image							bloomImage;
+	sf::Texture							bloomTexture;
 };
 
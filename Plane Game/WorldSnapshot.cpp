@@ -0,0 +1,148 @@
+#include "WorldSnapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+	const std::uint32_t Magic = 0x4e534750; // "PGSN"
+	const std::uint32_t Version = 2;
+	const std::size_t Alignment = 8;
+
+	struct FileHeader
+	{
+		std::uint32_t	magic;
+		std::uint32_t	version;
+		std::uint32_t	aircraftCount;
+		std::uint32_t	projectileCount;
+		std::uint32_t	pickupCount;
+		std::uint32_t	spawnCount;
+		std::uint32_t	segmentCount;
+		std::uint32_t	padding;
+	};
+
+	std::size_t align(std::size_t offset)
+	{
+		return (offset + Alignment - 1) & ~(Alignment - 1);
+	}
+
+	template <typename T>
+	void writeArray(std::vector<char>& buffer, std::size_t& offset, const T* data, std::size_t count)
+	{
+		offset = align(offset);
+		if (count > 0)
+			std::memcpy(buffer.data() + offset, data, count * sizeof(T));
+		offset += count * sizeof(T);
+	}
+
+	template <typename T>
+	void readArray(const char* data, std::size_t size, std::size_t& offset, std::vector<T>& output, std::size_t count)
+	{
+		offset = align(offset);
+		if (offset + count * sizeof(T) > size)
+			throw std::runtime_error("WorldSnapshot::readFrom - Truncated snapshot");
+
+		output.resize(count);
+		if (count > 0)
+			std::memcpy(output.data(), data + offset, count * sizeof(T));
+		offset += count * sizeof(T);
+	}
+
+	template <typename T>
+	std::size_t arraySize(std::size_t offset, const std::vector<T>& records)
+	{
+		return align(offset) + records.size() * sizeof(T);
+	}
+}
+
+WorldSnapshot::WorldSnapshot()
+	: world()
+	, aircraft()
+	, projectiles()
+	, pickups()
+	, spawns()
+	, segments()
+{
+}
+
+void WorldSnapshot::clear()
+{
+	world = WorldState();
+	aircraft.clear();
+	projectiles.clear();
+	pickups.clear();
+	spawns.clear();
+	segments.clear();
+}
+
+void WorldSnapshot::writeTo(std::vector<char>& buffer) const
+{
+	FileHeader header = { Magic, Version,
+		static_cast<std::uint32_t>(aircraft.size()), static_cast<std::uint32_t>(projectiles.size()),
+		static_cast<std::uint32_t>(pickups.size()), static_cast<std::uint32_t>(spawns.size()),
+		static_cast<std::uint32_t>(segments.size()), 0 };
+
+	std::size_t size = sizeof(header);
+	size = align(size) + sizeof(WorldState);
+	size = arraySize(size, aircraft);
+	size = arraySize(size, projectiles);
+	size = arraySize(size, pickups);
+	size = arraySize(size, spawns);
+	size = arraySize(size, segments);
+	buffer.assign(size, 0);
+
+	std::size_t offset = 0;
+	writeArray(buffer, offset, &header, 1);
+	writeArray(buffer, offset, &world, 1);
+	writeArray(buffer, offset, aircraft.data(), aircraft.size());
+	writeArray(buffer, offset, projectiles.data(), projectiles.size());
+	writeArray(buffer, offset, pickups.data(), pickups.size());
+	writeArray(buffer, offset, spawns.data(), spawns.size());
+	writeArray(buffer, offset, segments.data(), segments.size());
+}
+
+void WorldSnapshot::readFrom(const char* data, std::size_t size)
+{
+	FileHeader header;
+	if (size < sizeof(header))
+		throw std::runtime_error("WorldSnapshot::readFrom - Truncated snapshot");
+	std::memcpy(&header, data, sizeof(header));
+	if (header.magic != Magic || header.version != Version)
+		throw std::runtime_error("WorldSnapshot::readFrom - Incompatible snapshot");
+
+	std::size_t offset = sizeof(header);
+	offset = align(offset);
+	if (offset + sizeof(WorldState) > size)
+		throw std::runtime_error("WorldSnapshot::readFrom - Truncated snapshot");
+	std::memcpy(&world, data + offset, sizeof(WorldState));
+	offset += sizeof(WorldState);
+
+	readArray(data, size, offset, aircraft, header.aircraftCount);
+	readArray(data, size, offset, projectiles, header.projectileCount);
+	readArray(data, size, offset, pickups, header.pickupCount);
+	readArray(data, size, offset, spawns, header.spawnCount);
+	readArray(data, size, offset, segments, header.segmentCount);
+}
+
+bool WorldSnapshot::saveToFile(const std::string& filename) const
+{
+	std::vector<char> buffer;
+	writeTo(buffer);
+
+	std::ofstream out(filename, std::ios::binary);
+	out.write(buffer.data(), buffer.size());
+	return static_cast<bool>(out);
+}
+
+void WorldSnapshot::loadFromFile(const std::string& filename)
+{
+	std::ifstream in(filename, std::ios::binary | std::ios::ate);
+	if (!in)
+		throw std::runtime_error("WorldSnapshot::loadFromFile - Failed to open " + filename);
+
+	std::vector<char> buffer(static_cast<std::size_t>(in.tellg()));
+	in.seekg(0);
+	in.read(buffer.data(), buffer.size());
+	readFrom(buffer.data(), buffer.size());
+}
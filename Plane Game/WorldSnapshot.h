@@ -0,0 +1,133 @@
+#pragma once
+#include "Random.h"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Flat records of the simulation state of a World. Times are stored in
+// microseconds so a restored world continues bit for bit.
+struct AircraftState
+{
+	RandomStream					random;
+	std::int64_t					fireCountdown;
+	std::int64_t					explosionTime;
+	std::int32_t					type;
+	std::int32_t					hitpoints;
+	float							x;
+	float							y;
+	float							rotation;
+	float							vx;
+	float							vy;
+	float							travelledDistance;
+	std::uint32_t					directionIndex;
+	std::int32_t					missileAmmo;
+	std::int32_t					fireRateLevel;
+	std::int32_t					spreadLevel;
+	std::uint8_t					spawnedPickup;
+	std::uint8_t					playedExplosionEffect;
+	std::uint8_t					showExplosion;
+	std::uint8_t					padding;
+	// Index of the scheduled spawn that built it ahead of time, -1 once in the scene
+	std::int32_t					scheduled;
+	std::int32_t					identifier;
+};
+
+struct ProjectileState
+{
+	std::int32_t					type;
+	std::int32_t					hitpoints;
+	float							x;
+	float							y;
+	float							rotation;
+	float							vx;
+	float							vy;
+	float							targetX;
+	float							targetY;
+};
+
+struct PickupState
+{
+	std::int32_t					type;
+	std::int32_t					hitpoints;
+	float							x;
+	float							y;
+	float							vx;
+	float							vy;
+};
+
+struct ScheduledSpawnState
+{
+	enum Queue : std::uint8_t
+	{
+		DistanceHeap,
+		TimeHeap,
+		UpcomingByDistance,
+		UpcomingByTime,
+	};
+
+	std::uint64_t					sequence;
+	std::int64_t					delay;
+	std::int32_t					type;
+	float							x;
+	std::int32_t					formation;
+	std::uint32_t					count;
+	float							spacing;
+	float							distance;
+	float							key;
+	std::uint8_t					queue;
+	std::uint8_t					anchored;
+	std::uint8_t					padding[2];
+};
+
+struct BackgroundSegmentState
+{
+	std::int32_t					texture;
+	float							distance;
+	float							length;
+	float							blend;
+};
+
+struct WorldState
+{
+	std::uint64_t					randomSeed;
+	std::uint64_t					randomStreams;
+	std::uint64_t					levelCursors[6];
+	std::uint64_t					spawnSequence;
+	std::int64_t					spawnTime;
+	float							viewCenterX;
+	float							viewCenterY;
+	float							scrollSpeed;
+	std::uint32_t					padding;
+};
+
+// In memory the records live in one vector per type, reused between
+// captures. writeTo/readFrom use one contiguous buffer: a header of counts
+// followed by each array at an 8 byte aligned offset, so a mapped file can
+// be read in place.
+class WorldSnapshot
+{
+public:
+										WorldSnapshot();
+
+	void								clear();
+
+	void								writeTo(std::vector<char>& buffer) const;
+	// Throws on a foreign or truncated buffer
+	void								readFrom(const char* data, std::size_t size);
+
+	bool								saveToFile(const std::string& filename) const;
+	void								loadFromFile(const std::string& filename);
+
+public:
+	WorldState							world;
+	std::vector<AircraftState>			aircraft;
+	std::vector<ProjectileState>		projectiles;
+	std::vector<PickupState>			pickups;
+	std::vector<ScheduledSpawnState>	spawns;
+	std::vector<BackgroundSegmentState>	segments;
+};
+
+static_assert(std::is_trivially_copyable<AircraftState>::value, "Snapshot records are copied as bytes");
+static_assert(std::is_trivially_copyable<WorldState>::value, "Snapshot records are copied as bytes");